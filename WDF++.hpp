@@ -33,6 +33,8 @@
 //==============================================================================
 namespace WDF {
 //==============================================================================
+template <typename T> class Program;
+//==============================================================================
 // ** 1-PORT ** (base class for every WDF classes)
 //==============================================================================
 template <typename T>
@@ -45,6 +47,8 @@ class OnePort
         virtual String name () const { return name.isEmpty() ? label() : _name; }
         virtual String label () const = 0;
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p) { jassertfalse; return -1; }
+        //----------------------------------------------------------------------
         virtual inline void incident (T wave) = 0;
         //----------------------------------------------------------------------
         virtual inline T reflected () = 0;
@@ -157,6 +161,13 @@ class Serie : public ThreePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "--"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            const int l = left->compile (p), r = right->compile (p);
+            return p.add (Program<T>::serie, this, R(), 0.0, l, r,
+                          left->R()/R(), right->R()/R());
+        }
+        //----------------------------------------------------------------------
         virtual void connect (OnePort<T>* l, OnePort<T>* r)
         {
             left = l; right = r;
@@ -192,6 +203,14 @@ class Parallel : public ThreePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "||"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            const int l = left->compile (p), r = right->compile (p);
+            const T lrG = left->G() + right->G();
+            return p.add (Program<T>::parallel, this, R(), 0.0, l, r,
+                          left->G()/lrG, right->G()/lrG);
+        }
+        //----------------------------------------------------------------------
         virtual void connect (OnePort<T>* l, OnePort<T>* r)
         {
             left = l; right = r;
@@ -229,6 +248,11 @@ class Resistor : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "R"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::resistor, this, R());
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = 0; return port->b;
@@ -252,6 +276,11 @@ class Capacitor : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "C"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::capacitor, this, R(), state);
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = state; return port->b;
@@ -262,6 +291,9 @@ class Capacitor : public OnePort<T>
             port->a = wave; state = port->a;
         }
         //----------------------------------------------------------------------
+        inline T getState () const { return state; }
+        inline void setState (T s) { state = s; }
+        //----------------------------------------------------------------------
     private:
         T state;
         //----------------------------------------------------------------------
@@ -278,6 +310,11 @@ class Inductor : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "L"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::inductor, this, R(), state);
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = -state; return port->b;
@@ -288,6 +325,9 @@ class Inductor : public OnePort<T>
             port->a = wave; state = port->a;
         }
         //----------------------------------------------------------------------
+        inline T getState () const { return state; }
+        inline void setState (T s) { state = s; }
+        //----------------------------------------------------------------------
     private:
         T state;
         //----------------------------------------------------------------------
@@ -304,6 +344,11 @@ class OpenCircuit : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "Oc"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::openCircuit, this, R());
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = port->a; return port->b;
@@ -327,6 +372,11 @@ class ShortCircuit : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "Sc"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::shortCircuit, this, R());
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = -port->a; return port->b;
@@ -350,6 +400,11 @@ class VoltageSource : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "Vs"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::voltageSource, this, R(), Vs);
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = -port->a + 2.0 * Vs; return port->b;
@@ -376,6 +431,11 @@ class CurrentSource : public OnePort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "Is"; }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            return p.add (Program<T>::currentSource, this, R(), Is);
+        }
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             port->b = port->a + 2.0 * R() * Is; return port->b;
@@ -402,6 +462,13 @@ class IdealTransformer : public TwoPort<T>
         //----------------------------------------------------------------------
         virtual String label () const { return "][" }
         //----------------------------------------------------------------------
+        virtual int compile (Program<T>& p)
+        {
+            const int c = child->compile (p);
+            return p.add (Program<T>::transformer, this, R(), 0.0, c, -1,
+                          N, 1.0/N);
+        }
+        //----------------------------------------------------------------------
         virtual void connectChild (OnePort<T>* port)
         {
             T Rs = port.R();
@@ -425,6 +492,576 @@ class IdealTransformer : public TwoPort<T>
         //----------------------------------------------------------------------
 };
 //==============================================================================
+// ** WRIGHT OMEGA ** (w + log w = x, explicit diode solutions)
+//==============================================================================
+//
+//  fast() is branch-light (piecewise guess + two Newton steps, ~2e-5
+//  relative error) and vectorizes in sample loops. exact() adds one more
+//  Newton step (double precision).
+//  D'Angelo, Gabrielli, Turchet, "Fast Approximation of the Lambert W
+//  Function for Virtual Analog Modelling", DAFx-19.
+//
+//==============================================================================
+template <typename T>
+struct WrightOmega
+{
+    static inline T omega3 (T x) // initial guess
+    {
+        const T a = -1.314293149877800e-3, b = 4.775931364975583e-2,
+                c =  3.631952663804445e-1, d = 6.313183464296682e-1;
+        return (x < -2.0) ? exp (x - exp (x))       // w = exp (x - w)
+             : (x <  8.0) ? d + x*(c + x*(b + x*a))
+             :              x - log (x);
+    }
+    //--------------------------------------------------------------------------
+    static inline T newton (T w, T x) // on w + log w - x
+    {
+        return w - (w + log (w) - x) * w / (w + 1.0);
+    }
+    //--------------------------------------------------------------------------
+    // below -40, omega (x) = exp (x) to double precision (and for very
+    // negative x the Newton update would take the log of an underflowed w)
+    //--------------------------------------------------------------------------
+    static inline T fast (T x)
+    {
+        return (x < -40.0) ? exp (x) : newton (newton (omega3 (x), x), x);
+    }
+    static inline T exact (T x)
+    {
+        return (x < -40.0) ? exp (x) : newton (fast (x), x);
+    }
+};
+//==============================================================================
+// ** DIODE ** (Shockley diode at the root, explicit wave solution)
+//==============================================================================
+//
+//  i = Is (exp (v / (n.Vt)) - 1), with the port resistance R:
+//
+//      b = a + 2.R.Is - 2.n.Vt . omega (log (R.Is / (n.Vt)) + (a + R.Is) / (n.Vt))
+//
+//  Werner, Nangia, Smith, Abel, "Resolving Wave Digital Filters with
+//  Multiple/Multiport Nonlinearities", DAFx-15. R is the port resistance of
+//  the connected child (or the constructor value when used standalone).
+//  series > 1 models identical diodes in series (n scaled).
+//
+//==============================================================================
+template <typename T>
+class Diode : public OnePort<T>
+{
+    public:
+        Diode (T R, T I = 2.52e-9, T Vt = 25.85e-3, T n = 1.752,
+               int series = 1, String name = String::empty)
+            : OnePort (R, name), Is (I), nVt (n * Vt * series), Rcache (0),
+              accurate (false) {}
+        //----------------------------------------------------------------------
+        virtual String label () const { return "D"; }
+        //----------------------------------------------------------------------
+        virtual inline T reflected ()
+        {
+            this->port->b = solve (this->port->a); return this->port->b;
+        }
+        //----------------------------------------------------------------------
+        virtual inline void incident (T wave)
+        {
+            this->port->a = wave;
+        }
+        //----------------------------------------------------------------------
+        inline void setAccurate (bool exact) { accurate = exact; }
+        //----------------------------------------------------------------------
+    protected:
+        inline T solve (T a) // forward diode
+        {
+            const T R = this->R ();
+            if (R != Rcache) { Rcache = R; RIs = R * Is;
+                               lnRIs = log (RIs / nVt); }
+            const T x = lnRIs + (a + RIs) / nVt;
+            const T w = accurate ? WrightOmega<T>::exact (x)
+                                 : WrightOmega<T>::fast (x);
+            return a + 2.0*RIs - 2.0*nVt*w;
+        }
+        //----------------------------------------------------------------------
+        T Is, nVt;
+        T Rcache, RIs, lnRIs;
+        bool accurate;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// ** DIODE PAIR ** (antiparallel diodes at the root)
+//==============================================================================
+//
+//  Odd extension of the single diode solution (the reverse diode current
+//  is neglected, exact for |v| >> n.Vt):
+//
+//      b = sgn (a) . Diode (|a|)
+//
+//  Both polarities go through Diode::solve(), so the Wright omega underflow
+//  guard (below -40) covers the pair and the bridge as well.
+//
+//==============================================================================
+template <typename T>
+class DiodePair : public Diode<T>
+{
+    public:
+        DiodePair (T R, T Is = 2.52e-9, T Vt = 25.85e-3, T n = 1.752,
+                   int series = 1, String name = String::empty)
+            : Diode<T> (R, Is, Vt, n, series, name) {}
+        //----------------------------------------------------------------------
+        virtual String label () const { return "DD"; }
+        //----------------------------------------------------------------------
+        virtual inline T reflected ()
+        {
+            const T a = this->port->a;
+            const T b = this->solve (fabs (a));
+            this->port->b = (a < 0.0) ? -b : b; return this->port->b;
+        }
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// ** DIODE BRIDGE ** (full-wave bridge seen from its AC terminals)
+//==============================================================================
+//
+//  Two diodes of the bridge conduct in series for each polarity, the DC load
+//  being part of the port (child) resistance: an antiparallel pair of series
+//  pairs. current() is the (signed) AC current, |current()| flows in the load.
+//
+//==============================================================================
+template <typename T>
+class DiodeBridge : public DiodePair<T>
+{
+    public:
+        DiodeBridge (T R, T Is = 2.52e-9, T Vt = 25.85e-3, T n = 1.752,
+                     String name = String::empty)
+            : DiodePair<T> (R, Is, Vt, n, 2, name) {}
+        //----------------------------------------------------------------------
+        virtual String label () const { return "DB"; }
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// ** R-TYPE ** (scattering matrix adaptor for non series/parallel topologies)
+//==============================================================================
+//
+//  Ports are branches between the nodes of a small graph (node 0 = ground).
+//  connect() derives the scattering matrix once by modified nodal analysis:
+//  every port is replaced by its Thevenin equivalent (incident wave in
+//  series with the port resistance), the node voltages are solved for unit
+//  waves, and S = 2K - I where K maps incident waves to port voltages.
+//
+//  With a single external port left at R <= 0, that port is adapted (its
+//  resistance is the Thevenin resistance seen from it) and the adaptor is a
+//  plain one-port. With several external ports, they are the unadapted
+//  ports of a nonlinear multiport root, driven with gather() / scatter().
+//
+//      WDF::RType<double> rt (3);              // nodes 0, 1, 2
+//      rt.addChild (&R1, 1, 0);
+//      rt.addChild (&C1, 1, 2);
+//      rt.addChild (&R2, 2, 0);
+//      rt.addExternal (1, 2);                  // adapted, up-facing
+//      rt.connect ();
+//
+//==============================================================================
+template <typename T>
+class RType : public OnePort<T>
+{
+    public:
+        RType (int numberOfNodes, String name = String::empty)
+            : OnePort (1.0, name), numNodes (numberOfNodes), numPorts (0),
+              adapted (-1)
+        {}
+        //----------------------------------------------------------------------
+        virtual String label () const { return "RT"; }
+        //----------------------------------------------------------------------
+        int addChild (OnePort<T>* child, int p, int n)
+        {
+            Port x = { child, p, n, 0.0 };
+            ports.add (x);
+            return ports.size() - 1;
+        }
+        //----------------------------------------------------------------------
+        int addExternal (int p, int n, T R = 0.0) // R <= 0.0 : adapted
+        {
+            Port x = { nullptr, p, n, R };
+            ports.add (x);
+            return ports.size() - 1;
+        }
+        //----------------------------------------------------------------------
+        // derives S (and the node voltage map) from the port resistances
+        //----------------------------------------------------------------------
+        virtual void connect ()
+        {
+            numPorts = ports.size();
+            adapted = -1;
+            for (int j = 0; j < numPorts; ++j)
+            {
+                Port& x = ports.getReference (j);
+                if (x.child != nullptr) x.R = x.child->R();
+                else if (x.R <= 0.0) { jassert (adapted < 0); adapted = j; }
+            }
+            //------------------------------------------------------------------
+            if (adapted >= 0)
+            {
+                Port& x = ports.getReference (adapted);
+                x.R = 0.0; // excluded from the nodal matrix
+                x.R = thevenin (x.p, x.n);
+                port->Rp = x.R;
+            }
+            //------------------------------------------------------------------
+            const int N = numPorts, M = numNodes - 1;
+            HeapBlock<T> Z (M*M, true);
+            nodal (Z);
+            //------------------------------------------------------------------
+            // node voltages for a unit wave on each port: V = Z.B, B(p) = 1/R
+            //------------------------------------------------------------------
+            W.calloc (numNodes*N);
+            for (int k = 0; k < N; ++k)
+            {
+                const Port& x = ports.getReference (k);
+                for (int i = 1; i < numNodes; ++i)
+                {
+                    T v = 0.0;
+                    if (x.p > 0) v += Z[(i-1)*M + (x.p-1)] / x.R;
+                    if (x.n > 0) v -= Z[(i-1)*M + (x.n-1)] / x.R;
+                    W[i*N + k] = v;
+                }
+            }
+            //------------------------------------------------------------------
+            S.calloc (N*N);
+            for (int j = 0; j < N; ++j)
+            {
+                const Port& x = ports.getReference (j);
+                for (int k = 0; k < N; ++k)
+                    S[j*N + k] = 2.0 * (W[x.p*N + k] - W[x.n*N + k])
+                               - ((j == k) ? 1.0 : 0.0);
+            }
+            A.calloc (N);
+        }
+        //----------------------------------------------------------------------
+        // adapted one-port use
+        //----------------------------------------------------------------------
+        virtual inline T reflected ()
+        {
+            gather ();
+            A[adapted] = 0.0; // S(adapted, adapted) == 0
+            port->b = row (adapted);
+            return port->b;
+        }
+        //----------------------------------------------------------------------
+        virtual inline void incident (T wave)
+        {
+            port->a = wave;
+            A[adapted] = wave;
+            for (int j = 0; j < numPorts; ++j)
+                if (ports.getReference (j).child != nullptr)
+                    ports.getReference (j).child->incident (row (j));
+        }
+        //----------------------------------------------------------------------
+        // multiport use
+        //----------------------------------------------------------------------
+        inline void gather () // waves from the children
+        {
+            for (int j = 0; j < numPorts; ++j)
+            {
+                OnePort<T>* child = ports.getReference (j).child;
+                A[j] = (child != nullptr) ? child->reflected () : 0.0;
+            }
+        }
+        //----------------------------------------------------------------------
+        // wave toward port j from the children only (externals set to zero)
+        //----------------------------------------------------------------------
+        inline T partial (int j) const { return row (j); }
+        //----------------------------------------------------------------------
+        // node voltage from the children only, and its external port weights
+        //----------------------------------------------------------------------
+        inline T nodeVoltage (int node) const
+        {
+            T v = 0.0;
+            for (int k = 0; k < numPorts; ++k) v += W[node*numPorts + k] * A[k];
+            return v;
+        }
+        inline T weight (int node, int port) const { return W[node*numPorts + port]; }
+        //----------------------------------------------------------------------
+        inline T scattering (int j, int k) const { return S[j*numPorts + k]; }
+        inline T portR (int j) const { return ports.getReference (j).R; }
+        //----------------------------------------------------------------------
+        // set the external ports incident waves and scatter to the children
+        //----------------------------------------------------------------------
+        inline void scatter (const int* externals, const T* waves, int count)
+        {
+            for (int e = 0; e < count; ++e) A[externals[e]] = waves[e];
+            for (int j = 0; j < numPorts; ++j)
+                if (ports.getReference (j).child != nullptr)
+                    ports.getReference (j).child->incident (row (j));
+        }
+        //----------------------------------------------------------------------
+    private:
+        struct Port { OnePort<T>* child; int p, n; T R; };
+        //----------------------------------------------------------------------
+        Array<Port> ports;
+        HeapBlock<T> S, W, A; // scattering, node map, incident waves
+        int numNodes, numPorts, adapted;
+        //----------------------------------------------------------------------
+        inline T row (int j) const
+        {
+            const T* s = S + j*numPorts;
+            T y = 0.0;
+            for (int k = 0; k < numPorts; ++k) y += s[k] * A[k];
+            return y;
+        }
+        //----------------------------------------------------------------------
+        // inverse of the nodal conductance matrix (ground removed), ports
+        // with R == 0 are left out
+        //----------------------------------------------------------------------
+        void nodal (T* Z) const
+        {
+            const int M = numNodes - 1;
+            HeapBlock<T> G (M*M, true);
+            for (int j = 0; j < ports.size(); ++j)
+            {
+                const Port& x = ports.getReference (j);
+                if (x.R <= 0.0) continue;
+                const T g = 1.0 / x.R;
+                const int p = x.p - 1, n = x.n - 1;
+                if (p >= 0)           G[p*M + p] += g;
+                if (n >= 0)           G[n*M + n] += g;
+                if (p >= 0 && n >= 0) { G[p*M + n] -= g; G[n*M + p] -= g; }
+            }
+            //------------------------------------------------------------------
+            // Gauss-Jordan with partial pivoting
+            //------------------------------------------------------------------
+            for (int i = 0; i < M*M; ++i) Z[i] = 0.0;
+            for (int i = 0; i < M; ++i) Z[i*M + i] = 1.0;
+            for (int c = 0; c < M; ++c)
+            {
+                int pivot = c;
+                for (int r = c + 1; r < M; ++r)
+                    if (fabs (G[r*M + c]) > fabs (G[pivot*M + c])) pivot = r;
+                jassert (G[pivot*M + c] != 0.0); // floating node
+                for (int k = 0; k < M; ++k) { std::swap (G[c*M + k], G[pivot*M + k]);
+                                              std::swap (Z[c*M + k], Z[pivot*M + k]); }
+                const T d = 1.0 / G[c*M + c];
+                for (int k = 0; k < M; ++k) { G[c*M + k] *= d; Z[c*M + k] *= d; }
+                for (int r = 0; r < M; ++r)
+                {
+                    if (r == c) continue;
+                    const T f = G[r*M + c];
+                    for (int k = 0; k < M; ++k) { G[r*M + k] -= f*G[c*M + k];
+                                                  Z[r*M + k] -= f*Z[c*M + k]; }
+                }
+            }
+        }
+        //----------------------------------------------------------------------
+        T thevenin (int p, int n) const
+        {
+            const int M = numNodes - 1;
+            HeapBlock<T> Z (M*M, true);
+            nodal (Z);
+            const int i = p - 1, j = n - 1;
+            T R = 0.0;
+            if (i >= 0)           R += Z[i*M + i];
+            if (j >= 0)           R += Z[j*M + j];
+            if (i >= 0 && j >= 0) R -= Z[i*M + j] + Z[j*M + i];
+            return R;
+        }
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// ** PROGRAM ** (flattened tree, compiled once the tree is connected)
+//==============================================================================
+//
+//  compile() walks the tree once and lays every element out in post-order
+//  over contiguous arrays (structure of arrays). A child always comes before
+//  its parent, so the reflected pass is a forward loop and the incident pass
+//  a backward loop: no recursion, no virtual call, no pointer chasing.
+//
+//      WDF::Program<double> prog;
+//      prog.compile (&root);               // after root.connect (...)
+//      T b = prog.reflected ();
+//      prog.incident (f (b));
+//      T v = prog.voltage (prog.indexOf (&C1));
+//
+//  Reactive states live in the program while it runs, store() writes them
+//  back to the elements (before rewiring and recompiling for instance).
+//  When only element values change (same tree), refresh() updates the port
+//  resistances and adaptor coefficients in place instead of recompiling.
+//
+//==============================================================================
+template <typename T>
+class Program
+{
+    public:
+        enum Op { resistor, capacitor, inductor, openCircuit, shortCircuit,
+                  voltageSource, currentSource, serie, parallel, transformer };
+        //----------------------------------------------------------------------
+        Program () : valid (false) {}
+        //----------------------------------------------------------------------
+        bool compile (OnePort<T>* root)
+        {
+            clear ();
+            valid = true;
+            root->compile (*this);
+            valid = valid && size() > 0;
+            return valid;
+        }
+        //----------------------------------------------------------------------
+        // element values changed, same tree: recomputes the port resistances
+        // and adaptor coefficients in place, children first. Nothing is
+        // cleared or resized, so a reflected()/incident() running meanwhile
+        // sees old or new coefficients, never an empty program (compile() is
+        // for the wiring, before processing starts).
+        //----------------------------------------------------------------------
+        void refresh ()
+        {
+            T* rp = Rp.getRawDataPointer();
+            T* k1 = kl.getRawDataPointer();
+            T* k2 = kr.getRawDataPointer();
+            for (int n = 0; n < size(); ++n)
+            {
+                const int l = left[n], r = right[n];
+                switch (ops[n])
+                {
+                    case serie:
+                        rp[n] = rp[l] + rp[r];
+                        k1[n] = rp[l] / rp[n]; k2[n] = rp[r] / rp[n];   break;
+                    case parallel:
+                    {
+                        const T Gl = 1.0 / rp[l], Gr = 1.0 / rp[r];
+                        rp[n] = 1.0 / (Gl + Gr);
+                        k1[n] = Gl * rp[n]; k2[n] = Gr * rp[n];
+                    }                                                   break;
+                    case transformer:   rp[n] = rp[l] / (k1[n]*k1[n]);  break;
+                    default:            rp[n] = elements[n]->R ();      break;
+                };
+            }
+        }
+        //----------------------------------------------------------------------
+        // emitted by OnePort::compile (returns the node index)
+        //----------------------------------------------------------------------
+        int add (Op op, OnePort<T>* element, T R, T value = 0.0,
+                 int c1 = -1, int c2 = -1, T k1 = 0.0, T k2 = 0.0)
+        {
+            const bool adaptor = (op == serie || op == parallel);
+            if ((adaptor && (c1 < 0 || c2 < 0)) || (op == transformer && c1 < 0))
+                valid = false;
+            //------------------------------------------------------------------
+            ops.add (op); elements.add (element);
+            Rp.add (R); a.add (0.0); b.add (0.0); state.add (value);
+            left.add (c1); right.add (c2); kl.add (k1); kr.add (k2);
+            return size() - 1;
+        }
+        //----------------------------------------------------------------------
+        bool isValid () const { return valid; }
+        int size () const { return ops.size(); }
+        //----------------------------------------------------------------------
+        int indexOf (const OnePort<T>* element) const
+        {
+            return elements.indexOf (const_cast<OnePort<T>*> (element));
+        }
+        //----------------------------------------------------------------------
+        T R () const { return Rp.getLast(); }
+        //----------------------------------------------------------------------
+        T voltage (int n) const { return (a[n] + b[n]) / 2.0; }
+        T current (int n) const { return (a[n] - b[n]) / (Rp[n] + Rp[n]); }
+        //----------------------------------------------------------------------
+        // source value (Vs, Is) or reactive state (C, L)
+        //----------------------------------------------------------------------
+        void setValue (int n, T value) { state.getReference (n) = value; }
+        T getValue (int n) const { return state[n]; }
+        //----------------------------------------------------------------------
+        inline T reflected ()
+        {
+            const int*  op = ops.getRawDataPointer();
+            const int*  l  = left.getRawDataPointer();
+            const int*  r  = right.getRawDataPointer();
+            const T*    k1 = kl.getRawDataPointer();
+            const T*    k2 = kr.getRawDataPointer();
+            const T*    R  = Rp.getRawDataPointer();
+            const T*    s  = state.getRawDataPointer();
+            const T*    pa = a.getRawDataPointer();
+            T*          pb = b.getRawDataPointer();
+            //------------------------------------------------------------------
+            const int N = size();
+            for (int n = 0; n < N; ++n)
+            {
+                switch (op[n])
+                {
+                    case resistor:      pb[n] = 0.0;                        break;
+                    case capacitor:     pb[n] = s[n];                       break;
+                    case inductor:      pb[n] = -s[n];                      break;
+                    case openCircuit:   pb[n] = pa[n];                      break;
+                    case shortCircuit:  pb[n] = -pa[n];                     break;
+                    case voltageSource: pb[n] = -pa[n] + 2.0*s[n];          break;
+                    case currentSource: pb[n] = pa[n] + 2.0*R[n]*s[n];      break;
+                    case serie:         pb[n] = -(pb[l[n]] + pb[r[n]]);     break;
+                    case parallel:      pb[n] = k1[n]*pb[l[n]] + k2[n]*pb[r[n]];
+                                                                            break;
+                    case transformer:   pb[n] = k1[n]*pb[l[n]];             break;
+                    default:                                                break;
+                };
+            }
+            return pb[N - 1];
+        }
+        //----------------------------------------------------------------------
+        inline void incident (T wave)
+        {
+            const int*  op = ops.getRawDataPointer();
+            const int*  l  = left.getRawDataPointer();
+            const int*  r  = right.getRawDataPointer();
+            const T*    k1 = kl.getRawDataPointer();
+            const T*    k2 = kr.getRawDataPointer();
+            const T*    pb = b.getRawDataPointer();
+            T*          s  = state.getRawDataPointer();
+            T*          pa = a.getRawDataPointer();
+            //------------------------------------------------------------------
+            const int N = size();
+            pa[N - 1] = wave;
+            for (int n = N - 1; n >= 0; --n)
+            {
+                switch (op[n])
+                {
+                    case capacitor:
+                    case inductor:      s[n] = pa[n];                       break;
+                    case serie:
+                    case parallel:
+                    {
+                        const T w = pa[n] + pb[l[n]] + pb[r[n]];
+                        pa[l[n]] = pb[l[n]] - k1[n]*w;
+                        pa[r[n]] = pb[r[n]] - k2[n]*w;
+                    }                                                       break;
+                    case transformer:   pa[l[n]] = pa[n]*k2[n];             break;
+                    default:                                                break;
+                };
+            }
+        }
+        //----------------------------------------------------------------------
+        // write the reactive states back to the tree elements
+        //----------------------------------------------------------------------
+        void store () const
+        {
+            for (int n = 0; n < size(); ++n)
+            {
+                if (ops[n] == capacitor)
+                    static_cast<Capacitor<T>*> (elements[n])->setState (state[n]);
+                else if (ops[n] == inductor)
+                    static_cast<Inductor<T>*> (elements[n])->setState (state[n]);
+            }
+        }
+        //----------------------------------------------------------------------
+        void clear ()
+        {
+            // clearQuick: a recompile (parameter change) reuses the storage
+            ops.clearQuick(); elements.clearQuick(); Rp.clearQuick();
+            a.clearQuick(); b.clearQuick(); state.clearQuick();
+            left.clearQuick(); right.clearQuick(); kl.clearQuick(); kr.clearQuick();
+            valid = false;
+        }
+        //----------------------------------------------------------------------
+    private:
+        Array<int> ops, left, right;
+        Array<OnePort<T>*> elements;
+        Array<T> Rp, a, b, state, kl, kr;
+        bool valid;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
 /**
     EXTRA TEMPLATES
     ---------------
@@ -471,6 +1108,468 @@ class NewtonRaphson
         //----------------------------------------------------------------------
 };
 //==============================================================================
+// ** VECTOR NEWTON/RAPHSON ** (small coupled systems, analytic Jacobian)
+//==============================================================================
+//
+//  evaluate() returns the residuals F(x) and the Jacobian J = dF/dx (row
+//  major N x N). The unknowns x are kept between calls (warm start). Each
+//  Newton step is damped by halving until the residual norm decreases.
+//  converged tells whether the last solve met the step tolerance within
+//  maxIterations (false: the iteration cap, a line search that found no
+//  descent or a singular Jacobian ended it).
+//  solve (*this) from the derived class avoids the virtual call per step.
+//
+//  The starting point of a solve is set by the predictor: the previous
+//  solution (hold), a linear or quadratic extrapolation of the last
+//  solutions, or linearizedGuess() of the derived system (an explicit step
+//  of its model linearized at the previous solution, hold by default).
+//
+//==============================================================================
+enum NewtonPredictor
+{
+    holdPredictor, linearPredictor, quadraticPredictor, linearizedPredictor,
+    numPredictors
+};
+//------------------------------------------------------------------------------
+template <typename T, int N>
+class VectorNewton
+{
+    public:
+        VectorNewton (T guess = 0.0)
+            : maxIterations (20), maxHalvings (8), epsilon (1e-9), iterations (0),
+              converged (true), predictor (holdPredictor), history (0)
+        {
+            for (int i = 0; i < N; ++i) x[i] = guess;
+        }
+        //----------------------------------------------------------------------
+        inline int solve () { return solve (*this); }
+        //----------------------------------------------------------------------
+        // forget the previous solutions (after x was set from outside)
+        //----------------------------------------------------------------------
+        void resetPredictor () { history = 0; }
+        //----------------------------------------------------------------------
+        // explicit first guess from the previous solution x (default: hold)
+        //----------------------------------------------------------------------
+        inline void linearizedGuess (T*) {}
+        //----------------------------------------------------------------------
+        // static dispatch: a derived system passes itself (solve (*this)),
+        // its evaluate() is then called non-virtually and can be inlined
+        //----------------------------------------------------------------------
+        template <class System>
+        inline int solve (System& system)
+        {
+            predict (system);
+            //------------------------------------------------------------------
+            T F[N], J[N*N], dx[N], xn[N], Fn[N], Jn[N*N];
+            T norm = evaluateNorm (system, x, F, J);
+            converged = false;
+            //------------------------------------------------------------------
+            for (iterations = 0; iterations < maxIterations; ++iterations)
+            {
+                if (! linearSolve (J, F, dx)) break; // singular Jacobian
+                //--------------------------------------------------------------
+                T step = 0.0, scale = 0.0;
+                for (int i = 0; i < N; ++i)
+                {
+                    step  = jmax (step,  (T) fabs (dx[i]));
+                    scale = jmax (scale, (T) fabs (x[i]));
+                }
+                // a full step below tolerance: at the root, where |F|^2 may
+                // not decrease any more (rounding)
+                //--------------------------------------------------------------
+                if (step <= epsilon * (1.0 + scale))
+                {
+                    for (int i = 0; i < N; ++i) x[i] -= dx[i];
+                    ++iterations; converged = true; break;
+                }
+                //--------------------------------------------------------------
+                // damped line search on |F|^2
+                //--------------------------------------------------------------
+                T lambda = 1.0, applied = 1.0, normn = 0.0;
+                bool descent = false;
+                for (int h = 0; h <= maxHalvings; ++h, lambda *= 0.5)
+                {
+                    applied = lambda;
+                    for (int i = 0; i < N; ++i) xn[i] = x[i] - lambda*dx[i];
+                    normn = evaluateNorm (system, xn, Fn, Jn);
+                    if (normn <= (1.0 - 1e-4*lambda) * norm) { descent = true; break; }
+                }
+                //--------------------------------------------------------------
+                for (int i = 0; i < N; ++i)   x[i] = xn[i];
+                for (int i = 0; i < N; ++i)   F[i] = Fn[i];
+                for (int i = 0; i < N*N; ++i) J[i] = Jn[i];
+                norm = normn;
+                //--------------------------------------------------------------
+                // a stalled line search (no descent after maxHalvings) ends
+                // the solve unconverged, however small its last step
+                //--------------------------------------------------------------
+                if (! descent) { ++iterations; break; }
+                if (applied*step <= epsilon * (1.0 + scale))
+                {
+                    ++iterations; converged = true; break;
+                }
+            }
+            //------------------------------------------------------------------
+            for (int i = 0; i < N; ++i) { past[2][i] = past[1][i];
+                                          past[1][i] = past[0][i];
+                                          past[0][i] = x[i]; }
+            history = jmin (history + 1, 3);
+            return iterations;
+        }
+        //----------------------------------------------------------------------
+        // declare your implicit system: F(x) and J = dF/dx
+        //----------------------------------------------------------------------
+        virtual inline void evaluate (const T* x, T* F, T* J) = 0;
+        //----------------------------------------------------------------------
+        T x[N];             // unknowns (warm start)
+        int maxIterations;
+        int maxHalvings;
+        T epsilon;          // step tolerance (relative)
+        int iterations;     // last solve
+        bool converged;     // last solve
+        int predictor;      // NewtonPredictor
+        //----------------------------------------------------------------------
+    private:
+        T past[3][N];       // last solutions, most recent first
+        int history;        // valid entries of past
+        //----------------------------------------------------------------------
+        template <class System>
+        inline void predict (System& system)
+        {
+            switch (predictor)
+            {
+                case linearPredictor:
+                    if (history >= 2)
+                        for (int i = 0; i < N; ++i)
+                            x[i] = 2.0*past[0][i] - past[1][i];
+                    break;
+                case quadraticPredictor:
+                    if (history >= 3)
+                        for (int i = 0; i < N; ++i)
+                            x[i] = 3.0*(past[0][i] - past[1][i]) + past[2][i];
+                    else if (history == 2)
+                        for (int i = 0; i < N; ++i)
+                            x[i] = 2.0*past[0][i] - past[1][i];
+                    break;
+                case linearizedPredictor:
+                    if (history >= 1) system.System::linearizedGuess (x);
+                    break;
+                default: break;
+            }
+        }
+        //----------------------------------------------------------------------
+        static inline void call (VectorNewton& system, const T* x, T* F, T* J)
+        {
+            system.evaluate (x, F, J);              // virtual
+        }
+        template <class System>
+        static inline void call (System& system, const T* x, T* F, T* J)
+        {
+            system.System::evaluate (x, F, J);      // static
+        }
+        //----------------------------------------------------------------------
+        template <class System>
+        static inline T evaluateNorm (System& system, const T* x, T* F, T* J)
+        {
+            call (system, x, F, J);
+            T norm = 0.0;
+            for (int i = 0; i < N; ++i) norm += F[i]*F[i];
+            return norm;
+        }
+        //----------------------------------------------------------------------
+        // J.dx = F (Gaussian elimination with partial pivoting, J is copied)
+        //----------------------------------------------------------------------
+        static inline bool linearSolve (const T* J, const T* F, T* dx)
+        {
+            if (N == 1)
+            {
+                if (J[0] == 0.0) return false;
+                dx[0] = F[0] / J[0]; return true;
+            }
+            if (N == 2)
+            {
+                const T det = J[0]*J[3] - J[1]*J[2];
+                if (det == 0.0) return false;
+                dx[0] = (J[3]*F[0] - J[1]*F[1]) / det;
+                dx[1] = (J[0]*F[1] - J[2]*F[0]) / det;
+                return true;
+            }
+            //------------------------------------------------------------------
+            T A[N*N], y[N];
+            for (int i = 0; i < N*N; ++i) A[i] = J[i];
+            for (int i = 0; i < N; ++i)   y[i] = F[i];
+            for (int c = 0; c < N; ++c)
+            {
+                int pivot = c;
+                for (int r = c + 1; r < N; ++r)
+                    if (fabs (A[r*N + c]) > fabs (A[pivot*N + c])) pivot = r;
+                if (A[pivot*N + c] == 0.0) return false;
+                for (int k = 0; k < N; ++k) std::swap (A[c*N + k], A[pivot*N + k]);
+                std::swap (y[c], y[pivot]);
+                for (int r = c + 1; r < N; ++r)
+                {
+                    const T f = A[r*N + c] / A[c*N + c];
+                    for (int k = c; k < N; ++k) A[r*N + k] -= f*A[c*N + k];
+                    y[r] -= f*y[c];
+                }
+            }
+            for (int r = N - 1; r >= 0; --r)
+            {
+                T v = y[r];
+                for (int k = r + 1; k < N; ++k) v -= A[r*N + k]*dx[k];
+                dx[r] = v / A[r*N + r];
+            }
+            return true;
+        }
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// ** ANTIDERIVATIVE ANTIALIASING ** (memoryless nonlinearities)
+//==============================================================================
+//
+//  A nonlinearity is a class with f(x), its first antiderivative F1(x) and
+//  second antiderivative F2(x). ADAA<T, F> replaces f by the average of f
+//  over the last input segment (order 1, half a sample of delay) or over
+//  the last two segments (order 2, one sample of delay). When a divided
+//  difference is ill-conditioned it falls back to the midpoint value.
+//
+//      WDF::ADAA<double, WDF::HardClip<double>> clip (WDF::HardClip<double>
+//                                                     (-1.0, 1.0), 2);
+//      y = clip.process (x);
+//
+//==============================================================================
+template <typename T>
+class HardClip // clamp (k.x, lo, hi), lo <= 0 <= hi
+{
+    public:
+        HardClip (T lo_ = -1.0, T hi_ = 1.0, T k_ = 1.0)
+            : lo (lo_), hi (hi_), k (k_) {}
+        //----------------------------------------------------------------------
+        inline T f (T x) const
+        {
+            x *= k; return (x < lo) ? lo : (x > hi) ? hi : x;
+        }
+        inline T F1 (T x) const
+        {
+            x *= k; if (x >= lo && x <= hi) return 0.5*x*x / k;
+            const T c = (x < lo) ? lo : hi;
+            return (c*x - 0.5*c*c) / k;
+        }
+        inline T F2 (T x) const
+        {
+            x *= k; if (x >= lo && x <= hi) return x*x*x / (6.0*k*k);
+            const T c = (x < lo) ? lo : hi;
+            return (0.5*c*x*x - 0.5*c*c*x + c*c*c / 6.0) / (k*k);
+        }
+        //----------------------------------------------------------------------
+        T lo, hi, k;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+template <typename T>
+class Softplus // l.x + s.log (1 + exp (k.x + c))
+{
+    public:
+        Softplus (T s_ = 1.0, T k_ = 1.0, T c_ = 0.0, T l_ = 0.0)
+            : s (s_), k (k_), c (c_), l (l_) {}
+        //----------------------------------------------------------------------
+        inline T f (T x) const
+        {
+            return l*x + s*G0 (k*x + c);
+        }
+        inline T F1 (T x) const
+        {
+            return 0.5*l*x*x + s*G1 (k*x + c) / k;
+        }
+        inline T F2 (T x) const
+        {
+            return l*x*x*x / 6.0 + s*G2 (k*x + c) / (k*k);
+        }
+        //----------------------------------------------------------------------
+        // log (1 + e^y) and its antiderivatives -Li2 (-e^y), -Li3 (-e^y)
+        //----------------------------------------------------------------------
+        static inline T G0 (T y)
+        {
+            return (y > 0.0) ? y + log1p (exp (-y)) : log1p (exp (y));
+        }
+        //----------------------------------------------------------------------
+        static inline T G1 (T y)
+        {
+            if (y >  1.0) return pi2_6 + 0.5*y*y - G1 (-y);      // inversion
+            if (y < -1.0) return series (exp (y), 2);
+            //------------------------------------------------------------------
+            // Taylor series about 0 (log cosh coefficients)
+            //------------------------------------------------------------------
+            const T y2 = y*y;
+            T sum = 0.0, p = y*y2;
+            for (int n = 1; n <= numCoefficients; ++n, p *= y2)
+                sum += lncosh[n-1] * p / (2*n + 1);
+            return 0.5*pi2_6 + y*ln2 + 0.25*y2 + sum;
+        }
+        //----------------------------------------------------------------------
+        static inline T G2 (T y)
+        {
+            if (y >  1.0) return pi2_6*y + y*y*y / 6.0 + G2 (-y); // inversion
+            if (y < -1.0) return series (exp (y), 3);
+            //------------------------------------------------------------------
+            const T y2 = y*y;
+            T sum = 0.0, p = y2*y2;
+            for (int n = 1; n <= numCoefficients; ++n, p *= y2)
+                sum += lncosh[n-1] * p / ((2*n + 1) * (2*n + 2));
+            return eta3 + 0.5*pi2_6*y + 0.5*ln2*y2 + y*y2 / 12.0 + sum;
+        }
+        //----------------------------------------------------------------------
+        T s, k, c, l;
+        //----------------------------------------------------------------------
+    private:
+        //----------------------------------------------------------------------
+        // -Li_n (-u) = sum (-1)^(j+1) u^j / j^n, for 0 < u < 1/e
+        //----------------------------------------------------------------------
+        static inline T series (T u, int n)
+        {
+            T sum = 0.0, p = u;
+            for (int j = 1; j <= 40; ++j, p *= -u)
+            {
+                const T term = p / ((n == 2) ? T (j*j) : T (j*j*j));
+                sum += term;
+                if (fabs (term) < 1e-17 * fabs (sum)) break;
+            }
+            return sum;
+        }
+        //----------------------------------------------------------------------
+        enum { numCoefficients = 13 };
+        static const T lncosh[numCoefficients];
+        static const T pi2_6, ln2, eta3;
+        //----------------------------------------------------------------------
+};
+//------------------------------------------------------------------------------
+template <typename T> const T Softplus<T>::pi2_6 = 1.64493406684822643647;
+template <typename T> const T Softplus<T>::ln2   = 0.69314718055994530942;
+template <typename T> const T Softplus<T>::eta3  = 0.90154267736969571405;
+//------------------------------------------------------------------------------
+// log cosh (y/2) = sum c_n y^2n, c_n = (2^2n - 1) B_2n / (2n (2n)!)
+//------------------------------------------------------------------------------
+template <typename T> const T Softplus<T>::lncosh[] =
+{
+     1.25000000000000000e-01, -5.20833333333333304e-03,  3.47222222222222235e-04,
+    -2.63516865079365092e-05,  2.13569223985890671e-06, -1.80322988482710712e-07,
+     1.56604354273005063e-08, -1.38839186387187799e-09,  1.25043114756602399e-10,
+    -1.14025647279525991e-11,  1.05029214045453626e-12, -9.75487726015767357e-14,
+     9.12346809490882767e-15
+};
+//==============================================================================
+template <typename T, class A, class B>
+class Sum // a + b
+{
+    public:
+        Sum (const A& a_ = A(), const B& b_ = B()) : a (a_), b (b_) {}
+        //----------------------------------------------------------------------
+        inline T f  (T x) const { return a.f  (x) + b.f  (x); }
+        inline T F1 (T x) const { return a.F1 (x) + b.F1 (x); }
+        inline T F2 (T x) const { return a.F2 (x) + b.F2 (x); }
+        //----------------------------------------------------------------------
+        A a; B b;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+template <typename T, class F>
+class ADAA
+{
+    public:
+        ADAA (const F& nonlinearity = F(), int order_ = 1)
+            : f (nonlinearity), order (order_), epsilon (1e-6),
+              x1 (0.0), x2 (0.0)
+        {
+            refresh ();
+        }
+        //----------------------------------------------------------------------
+        // order 0 (plain), 1 or 2
+        //----------------------------------------------------------------------
+        void setOrder (int o) { order = jlimit (0, 2, o); refresh (); }
+        int getOrder () const { return order; }
+        //----------------------------------------------------------------------
+        // call after changing the nonlinearity parameters
+        //----------------------------------------------------------------------
+        void refresh ()
+        {
+            F1x1 = f.F1 (x1);
+            F2x1 = f.F2 (x1);
+            D1 = difference (x1, x2, f.F2 (x2), F2x1);
+        }
+        //----------------------------------------------------------------------
+        void reset (T x = 0.0) { x1 = x2 = x; refresh (); }
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s) { s.io (x1); s.io (x2); refresh (); }
+        //----------------------------------------------------------------------
+        inline T process (T x)
+        {
+            switch (order)
+            {
+                case 1:  return first (x);
+                case 2:  return second (x);
+                default: x2 = x1; x1 = x; return f.f (x);
+            }
+        }
+        //----------------------------------------------------------------------
+        F f; // nonlinearity
+        //----------------------------------------------------------------------
+    private:
+        //----------------------------------------------------------------------
+        inline bool illConditioned (T d, T x) const
+        {
+            return fabs (d) < epsilon * (1.0 + fabs (x));
+        }
+        //----------------------------------------------------------------------
+        // (F2 (x) - F2 (x1)) / (x - x1), or F1 at the midpoint
+        //----------------------------------------------------------------------
+        inline T difference (T x, T x1_, T F2x1_, T F2x) const
+        {
+            const T d = x - x1_;
+            return illConditioned (d, x) ? f.F1 (0.5 * (x + x1_))
+                                         : (F2x - F2x1_) / d;
+        }
+        //----------------------------------------------------------------------
+        inline T first (T x)
+        {
+            const T F1x = f.F1 (x), d = x - x1;
+            const T y = illConditioned (d, x) ? f.f (0.5 * (x + x1))
+                                              : (F1x - F1x1) / d;
+            x2 = x1; x1 = x; F1x1 = F1x;
+            return y;
+        }
+        //----------------------------------------------------------------------
+        inline T second (T x)
+        {
+            const T F2x = f.F2 (x);
+            const T D0 = difference (x, x1, F2x1, F2x);
+            const T d = x - x2;
+            T y;
+            if (! illConditioned (d, x))
+            {
+                y = 2.0 * (D0 - D1) / d;
+            }
+            else
+            {
+                //--------------------------------------------------------------
+                // x ~ x2: expand about the midpoint xb = (x + x2) / 2
+                //--------------------------------------------------------------
+                const T xb = 0.5 * (x + x2), db = xb - x1;
+                y = illConditioned (db, xb)
+                  ? f.f (0.5 * (xb + x1))
+                  : 2.0 * (f.F1 (xb) + (F2x1 - f.F2 (xb)) / db) / db;
+            }
+            x2 = x1; x1 = x; F2x1 = F2x; D1 = D0;
+            return y;
+        }
+        //----------------------------------------------------------------------
+        int order;
+        T epsilon;              // relative ill-conditioning threshold
+        T x1, x2;               // past inputs
+        T F1x1, F2x1, D1;       // cached antiderivatives
+        //----------------------------------------------------------------------
+};
+//==============================================================================
 } // namespace WDF
 //==============================================================================
 #endif  // __WDF_DEFINITION_HPP_870F9F26__
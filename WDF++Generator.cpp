@@ -0,0 +1,47 @@
+//==============================================================================
+/**
+    WDF++Generator
+    --------------
+    Build-time tool: netlist in, specialized WDF++ circuit class out.
+
+        WDF++Generator circuit.net [circuit.hpp]
+
+    Writes to stdout when no output file is given. See WDF++Generator.hpp
+    for the netlist syntax.
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "WDF++Generator.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::fprintf (stderr, "usage: WDF++Generator circuit.net [circuit.hpp]\n");
+        return 1;
+    }
+    //--------------------------------------------------------------------------
+    const File input (File::getCurrentWorkingDirectory().getChildFile (argv[1]));
+    if (! input.existsAsFile ())
+    {
+        std::fprintf (stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    //--------------------------------------------------------------------------
+    WDF::Generator::Circuit circuit;
+    if (! circuit.parse (input.loadFileAsString ()))
+    {
+        std::fprintf (stderr, "%s: %s\n", argv[1], circuit.error().toRawUTF8());
+        return 1;
+    }
+    //--------------------------------------------------------------------------
+    const String code = circuit.emit ();
+    if (argc < 3) { std::fputs (code.toRawUTF8(), stdout); return 0; }
+    //--------------------------------------------------------------------------
+    const File output (File::getCurrentWorkingDirectory().getChildFile (argv[2]));
+    return output.replaceWithText (code) ? 0 : 1;
+}
+//==============================================================================
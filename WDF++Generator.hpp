@@ -0,0 +1,400 @@
+//==============================================================================
+/**
+    WDF++ Generator "netlist to specialized C++ WDF circuit"
+    ----------------------------------------------------------------------------
+    Reads a SPICE-like netlist, decomposes it into a series/parallel adaptor
+    tree rooted at the nonlinear port and emits an allocation-free C++ class:
+    port resistances and adaptor coefficients are computed once in prepare(),
+    the scattering is straight-line code over plain members.
+    ----------------------------------------------------------------------------
+    Netlist:
+
+        * comment                           (also ';' to end of line)
+        .name  ClassName
+        R<id>  n+ n-  value                 resistor
+        C<id>  n+ n-  value                 capacitor (trapezoidal)
+        L<id>  n+ n-  value                 inductor (trapezoidal)
+        V<id>  n+ n-  volts  Rseries        resistive voltage source
+        I<id>  n+ n-  amps   Rparallel      resistive current source
+        X<id>  n+ n-                        nonlinear port (tree root)
+        .end
+
+    Values accept SI suffixes (f p n u m k meg g t), node 0 is ground.
+    Source values can be changed at runtime with set<id> (value).
+
+    The generated one-port is used like any WDF++ tree below a nonlinearity:
+
+        T a = circuit.reflected ();         // wave toward the nonlinearity
+        circuit.incident (f (a, circuit.R()));
+        T v = circuit.voltageC1 ();         // V(n+) - V(n-) of C1
+
+    Only series/parallel reducible circuits are supported; anything else is
+    reported (it needs an R-type adaptor).
+**/
+//==============================================================================
+#ifndef __WDF_GENERATOR_HPP_6E1D03B7__
+#define __WDF_GENERATOR_HPP_6E1D03B7__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+namespace WDF {
+namespace Generator {
+//==============================================================================
+struct Node
+{
+    enum Kind { resistor, capacitor, inductor, voltageSource, currentSource,
+                serie, parallel };
+    //--------------------------------------------------------------------------
+    Kind kind;
+    String name;        // element name (leaves)
+    double value, R;    // element value, source resistance
+    int left, right;    // children (adaptors)
+    bool flipped;       // leaf orientation reversed by the decomposition
+};
+//------------------------------------------------------------------------------
+struct Edge { int u, v, node; };
+//==============================================================================
+class Circuit
+{
+    public:
+        Circuit () : className ("Circuit"), rootNode (-1), rootP (-1), rootN (-1) {}
+        //----------------------------------------------------------------------
+        // parse + decompose, returns false and sets error() on failure
+        //----------------------------------------------------------------------
+        bool parse (const String& netlist)
+        {
+            StringArray lines;
+            lines.addLines (netlist);
+            //------------------------------------------------------------------
+            for (int i = 0; i < lines.size(); ++i)
+            {
+                String line = lines[i].upToFirstOccurrenceOf (";", false, false).trim();
+                if (line.isEmpty() || line.startsWithChar ('*')) continue;
+                //--------------------------------------------------------------
+                StringArray tok;
+                tok.addTokens (line, " \t", String::empty);
+                tok.removeEmptyStrings ();
+                const String id = tok[0];
+                const String where = "line " + String (i + 1) + ": ";
+                //--------------------------------------------------------------
+                if (id.equalsIgnoreCase (".end")) break;
+                if (id.equalsIgnoreCase (".name")) { className = tok[1]; continue; }
+                //--------------------------------------------------------------
+                const juce_wchar c = CharacterFunctions::toUpperCase (id[0]);
+                const int need = (c == 'X') ? 3 : (c == 'V' || c == 'I') ? 5 : 4;
+                if (tok.size() < need) return fail (where + "missing fields");
+                //--------------------------------------------------------------
+                const int u = node (tok[1]), v = node (tok[2]);
+                if (c == 'X')
+                {
+                    if (rootP >= 0) return fail (where + "more than one nonlinear port");
+                    rootP = u; rootN = v; rootName = id;
+                    continue;
+                }
+                //--------------------------------------------------------------
+                Node n;
+                n.name = id; n.left = n.right = -1; n.flipped = false;
+                n.value = number (tok[3]); n.R = 0.0;
+                switch (c)
+                {
+                    case 'R': n.kind = Node::resistor;      break;
+                    case 'C': n.kind = Node::capacitor;     break;
+                    case 'L': n.kind = Node::inductor;      break;
+                    case 'V': n.kind = Node::voltageSource; n.R = number (tok[4]); break;
+                    case 'I': n.kind = Node::currentSource; n.R = number (tok[4]); break;
+                    default: return fail (where + "unknown element " + id);
+                };
+                if ((c == 'V' || c == 'I') && n.R <= 0.0)
+                    return fail (where + "source resistance must be > 0");
+                //--------------------------------------------------------------
+                nodes.add (n);
+                Edge e = { u, v, nodes.size() - 1 };
+                edges.add (e);
+            }
+            //------------------------------------------------------------------
+            if (rootP < 0) return fail ("no nonlinear port (X element)");
+            return decompose ();
+        }
+        //----------------------------------------------------------------------
+        const String& error () const { return errorMessage; }
+        const String& name () const { return className; }
+        //----------------------------------------------------------------------
+        String emit () const;
+        //----------------------------------------------------------------------
+    private:
+        Array<Node> nodes;
+        Array<Edge> edges;
+        StringArray nodeNames;
+        String className, rootName, errorMessage;
+        int rootNode, rootP, rootN;
+        //----------------------------------------------------------------------
+        bool fail (const String& message) { errorMessage = message; return false; }
+        //----------------------------------------------------------------------
+        int node (const String& n)
+        {
+            const String key = (n == "gnd" || n == "GND") ? "0" : n;
+            if (! nodeNames.contains (key)) nodeNames.add (key);
+            return nodeNames.indexOf (key);
+        }
+        //----------------------------------------------------------------------
+        static double number (const String& s)
+        {
+            const String t = s.toLowerCase();
+            const double x = t.getDoubleValue();
+            const String suffix = t.trimCharactersAtStart ("0123456789.+-e");
+            if (suffix.startsWith ("meg")) return x * 1e6;
+            switch (suffix[0])
+            {
+                case 'f': return x * 1e-15;  case 'p': return x * 1e-12;
+                case 'n': return x * 1e-9;   case 'u': return x * 1e-6;
+                case 'm': return x * 1e-3;   case 'k': return x * 1e3;
+                case 'g': return x * 1e9;    case 't': return x * 1e12;
+                default:  return x;
+            };
+        }
+        //----------------------------------------------------------------------
+        void flip (int n)
+        {
+            Node& x = nodes.getReference (n);
+            if (x.left < 0) { x.flipped = !x.flipped; return; }
+            flip (x.left); flip (x.right);
+        }
+        //----------------------------------------------------------------------
+        int combine (Node::Kind kind, int l, int r)
+        {
+            Node n;
+            n.kind = kind; n.left = l; n.right = r;
+            n.value = n.R = 0.0; n.flipped = false;
+            nodes.add (n);
+            return nodes.size() - 1;
+        }
+        //----------------------------------------------------------------------
+        int degree (int n) const
+        {
+            int d = 0;
+            for (int i = 0; i < edges.size(); ++i)
+                d += (edges[i].u == n) + (edges[i].v == n);
+            return d;
+        }
+        //----------------------------------------------------------------------
+        // Series/parallel reduction of the graph between the two terminals
+        // of the nonlinear port. Edge orientation is kept (u -> v means
+        // V(u) - V(v)), reversed subtrees get their sources flipped.
+        //----------------------------------------------------------------------
+        bool decompose ()
+        {
+            bool changed = true;
+            while (changed && edges.size() > 1)
+            {
+                changed = false;
+                //--------------------------------------------------------------
+                // parallel: two edges on the same pair of nodes
+                //--------------------------------------------------------------
+                for (int i = 0; i < edges.size() && !changed; ++i)
+                for (int j = i + 1; j < edges.size() && !changed; ++j)
+                {
+                    Edge a = edges[i], b = edges[j];
+                    const bool same = (a.u == b.u && a.v == b.v);
+                    const bool swap = (a.u == b.v && a.v == b.u);
+                    if (!same && !swap) continue;
+                    if (swap) flip (b.node);
+                    a.node = combine (Node::parallel, a.node, b.node);
+                    edges.set (i, a); edges.remove (j);
+                    changed = true;
+                }
+                //--------------------------------------------------------------
+                // series: an inner node shared by exactly two edges
+                //--------------------------------------------------------------
+                for (int m = 0; m < nodeNames.size() && !changed; ++m)
+                {
+                    if (m == rootP || m == rootN || degree (m) != 2) continue;
+                    int i = -1, j = -1;
+                    for (int k = 0; k < edges.size(); ++k)
+                        if (edges[k].u == m || edges[k].v == m) { if (i < 0) i = k; else j = k; }
+                    if (j < 0) continue; // self loop
+                    //----------------------------------------------------------
+                    Edge a = edges[i], b = edges[j];
+                    if (a.v != m) { flip (a.node); std::swap (a.u, a.v); } // x -> m
+                    if (b.u != m) { flip (b.node); std::swap (b.u, b.v); } // m -> y
+                    Edge e = { a.u, b.v, combine (Node::serie, a.node, b.node) };
+                    edges.set (i, e); edges.remove (j);
+                    changed = true;
+                }
+                //--------------------------------------------------------------
+                // dangling: an inner node with a single edge carries no current
+                //--------------------------------------------------------------
+                for (int m = 0; m < nodeNames.size() && !changed; ++m)
+                {
+                    if (m == rootP || m == rootN || degree (m) != 1) continue;
+                    for (int k = 0; k < edges.size(); ++k)
+                        if (edges[k].u == m || edges[k].v == m) { edges.remove (k); break; }
+                    changed = true;
+                }
+            }
+            //------------------------------------------------------------------
+            if (edges.size() != 1)
+                return fail ("circuit is not series/parallel reducible"
+                             " (needs an R-type adaptor)");
+            //------------------------------------------------------------------
+            Edge e = edges[0];
+            if (! ((e.u == rootP && e.v == rootN) || (e.u == rootN && e.v == rootP)))
+                return fail ("the circuit does not reduce onto the nonlinear port");
+            if (e.u != rootP) flip (e.node);
+            rootNode = e.node;
+            return true;
+        }
+        //----------------------------------------------------------------------
+        struct Code { String prepare, reset, init, up, down, members, access; };
+        void emitNode (int n, int sign, Code& c) const;
+};
+//==============================================================================
+static inline String literal (double x)
+{
+    return String::formatted ("%.17g", x);
+}
+//------------------------------------------------------------------------------
+// Post-order walk: 'up' gets children before parents, 'down' the reverse
+// (prepended). A series adaptor inverts the polarity seen from its parent,
+// 'sign' tracks that down to the sources.
+//------------------------------------------------------------------------------
+inline void Circuit::emitNode (int n, int sign, Code& c) const
+{
+    const Node& x = nodes.getReference (n);
+    const String k (n);
+    const String a = "a" + k, b = "b" + k, R = "R" + k;
+    String& prepare = c.prepare; String& up = c.up; String& down = c.down;
+    String& members = c.members; String& access = c.access;
+    members << "        T " << a << ", " << b << ", " << R;
+    c.reset << "            " << a << " = " << b << " = 0.0;\n";
+    //--------------------------------------------------------------------------
+    if (x.left >= 0)
+    {
+        const int s = (x.kind == Node::serie) ? -sign : sign;
+        emitNode (x.left,  s, c);
+        emitNode (x.right, s, c);
+        //----------------------------------------------------------------------
+        const String l (x.left), r (x.right);
+        members << ", k" << k << "l, k" << k << "r;\n";
+        if (x.kind == Node::serie)
+        {
+            prepare << "            " << R << " = R" << l << " + R" << r << ";\n"
+                    << "            k" << k << "l = R" << l << " / " << R << "; "
+                    << "k" << k << "r = R" << r << " / " << R << ";\n";
+            up      << "            " << b << " = -(b" << l << " + b" << r << ");\n";
+            down     = "            { const T w = " + a + " + b" + l + " + b" + r + ";\n"
+                     + "              a" + l + " = b" + l + " - k" + k + "l*w;\n"
+                     + "              a" + r + " = b" + r + " - k" + k + "r*w; }\n"
+                     + down;
+        }
+        else
+        {
+            prepare << "            " << R << " = (R" << l << " * R" << r << ")"
+                    << " / (R" << l << " + R" << r << ");\n"
+                    << "            k" << k << "l = " << R << " / R" << l << "; "
+                    << "k" << k << "r = " << R << " / R" << r << ";\n";
+            up      << "            " << b << " = k" << k << "l*b" << l
+                    << " + k" << k << "r*b" << r << ";\n";
+            down     = "            a" + l + " = " + a + " + " + b + " - b" + l + ";\n"
+                     + "            a" + r + " = " + a + " + " + b + " - b" + r + ";\n"
+                     + down;
+        }
+        return;
+    }
+    //--------------------------------------------------------------------------
+    // leaves
+    //--------------------------------------------------------------------------
+    const int s = x.flipped ? -sign : sign;
+    const String S = (s < 0) ? "-" : "";
+    const String v = literal (x.value);
+    switch (x.kind)
+    {
+        case Node::resistor:
+            members << ";\n";
+            prepare << "            " << R << " = " << v << ";\n";
+            up      << "            " << b << " = 0.0;\n";
+            break;
+        case Node::capacitor:
+            members << ", s" << k << ";\n";
+            c.reset << "            s" << k << " = 0.0;\n";
+            prepare << "            " << R << " = 1.0 / (2.0 * Fs * " << v << ");\n";
+            up      << "            " << b << " = s" << k << ";\n";
+            down     = "            s" + k + " = " + a + ";\n" + down;
+            break;
+        case Node::inductor:
+            members << ", s" << k << ";\n";
+            c.reset << "            s" << k << " = 0.0;\n";
+            prepare << "            " << R << " = 2.0 * Fs * " << v << ";\n";
+            up      << "            " << b << " = -s" << k << ";\n";
+            down     = "            s" + k + " = " + a + ";\n" + down;
+            break;
+        case Node::voltageSource:
+            members << ", e" << k << ";\n";
+            prepare << "            " << R << " = " << literal (x.R) << ";\n";
+            up      << "            " << b << " = e" << k << ";\n";
+            access  << "        void set" << x.name << " (T value) { e" << k
+                    << " = " << S << "value; }\n";
+            c.init  << "            set" << x.name << " (" << v << ");\n";
+            break;
+        case Node::currentSource:
+            members << ", e" << k << ";\n";
+            prepare << "            " << R << " = " << literal (x.R) << ";\n";
+            up      << "            " << b << " = " << R << " * e" << k << ";\n";
+            access  << "        void set" << x.name << " (T value) { e" << k
+                    << " = " << S << "value; }\n";
+            c.init  << "            set" << x.name << " (" << v << ");\n";
+            break;
+        default: break;
+    };
+    //--------------------------------------------------------------------------
+    access << "        T voltage" << x.name << " () const { return " << S
+           << "(" << a << " + " << b << ") * 0.5; }\n"
+           << "        T current" << x.name << " () const { return " << S
+           << "(" << a << " - " << b << ") / (2.0 * " << R << "); }\n";
+}
+//------------------------------------------------------------------------------
+inline String Circuit::emit () const
+{
+    Code c;
+    emitNode (rootNode, 1, c);
+    //--------------------------------------------------------------------------
+    const String r (rootNode);
+    String out;
+    out << "//==============================================================================\n"
+        << "// Generated by WDF++Generator, do not edit: regenerate from the netlist.\n"
+        << "// Root: nonlinear port " << rootName << ", voltage V(+) - V(-).\n"
+        << "//==============================================================================\n"
+        << "template <typename T>\n"
+        << "class " << className << "\n"
+        << "{\n"
+        << "    public:\n"
+        << "        " << className << " (T Fs)\n"
+        << "        {\n            prepare (Fs); reset ();\n" << c.init << "        }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << "        void prepare (T Fs)\n"
+        << "        {\n" << c.prepare << "        }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << "        void reset ()\n"
+        << "        {\n" << c.reset << "        }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << "        T R () const { return R" << r << "; }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << "        inline T reflected ()\n"
+        << "        {\n" << c.up << "            return b" << r << ";\n        }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << "        inline void incident (T wave)\n"
+        << "        {\n            a" << r << " = wave;\n" << c.down << "        }\n"
+        << "        //----------------------------------------------------------------------\n"
+        << c.access
+        << "        //----------------------------------------------------------------------\n"
+        << "    private:\n"
+        << c.members
+        << "        //----------------------------------------------------------------------\n"
+        << "};\n";
+    return out;
+}
+//==============================================================================
+} // namespace Generator
+} // namespace WDF
+//==============================================================================
+#endif  // __WDF_GENERATOR_HPP_6E1D03B7__
+//==============================================================================
@@ -0,0 +1,137 @@
+//==============================================================================
+/**
+    Wavechild670 streaming daemon
+    -----------------------------
+    Runs the limiter as a long-lived local process on shared memory rings.
+
+        Wavechild670Daemon [--rate 48000] [--block 256] [--capacity 8192]
+                           --stream name[:float|int24|int16] ...
+
+        Wavechild670Daemon --client name [--seconds 10] [--block 256]
+
+        Wavechild670Daemon --set name:index=value ...
+
+    Each --stream creates /wc670-<name> (planar stereo frames) and processes
+    it in place until SIGINT/SIGTERM, printing per block latency statistics
+    every second. --client drives an existing stream with synthetic audio
+    and prints its latency statistics (offline validation). --set sends a
+    limiter parameter (index and normalized value, as the plugin) to a
+    running stream, applied between blocks.
+    The real-time safety harness is run by Wavechild670RealtimeTest.
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_SharedMemoryStream.hpp"
+//------------------------------------------------------------------------------
+#include <csignal>
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+static volatile std::sig_atomic_t running = 1;
+static void stop (int) { running = 0; }
+//------------------------------------------------------------------------------
+static String ringName (const String& stream) { return "/wc670-" + stream; }
+//------------------------------------------------------------------------------
+static void print (const String& s, const Stream::LatencyStats& l)
+{
+    std::printf ("%s: %lld blocks, latency last %.3f ms, min %.3f ms,"
+                 " mean %.3f ms, max %.3f ms\n", s.toRawUTF8(),
+                 (long long) l.count, l.last * 1e3, l.min * 1e3,
+                 l.mean * 1e3, l.max * 1e3);
+}
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    double rate = 48000.0, seconds = 10.0;
+    int block = 256, capacity = 8192;
+    StringArray streams, settings;
+    String client;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rate")     rate = val.getDoubleValue();
+        else if (opt == "--block")    block = val.getIntValue();
+        else if (opt == "--capacity") capacity = nextPowerOfTwo (val.getIntValue());
+        else if (opt == "--seconds")  seconds = val.getDoubleValue();
+        else if (opt == "--stream")   streams.add (val);
+        else if (opt == "--client")   client = val;
+        else if (opt == "--set")      settings.add (val);
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    //--------------------------------------------------------------------------
+    // parameter changes to running streams
+    //--------------------------------------------------------------------------
+    if (settings.size() > 0)
+    {
+        for (int i = 0; i < settings.size(); ++i)
+        {
+            const String name  = settings[i].upToLastOccurrenceOf (":", false, false);
+            const String param = settings[i].fromLastOccurrenceOf (":", false, false);
+            const int index = param.upToFirstOccurrenceOf ("=", false, false).getIntValue();
+            const float value = param.fromFirstOccurrenceOf ("=", false, false).getFloatValue();
+            Stream::SharedRing ring;
+            if (! param.containsChar ('=') || ! isPositiveAndBelow (index, (int) numParameters))
+                { std::fprintf (stderr, "bad setting %s\n", settings[i].toRawUTF8());
+                  return 1; }
+            if (! ring.open (ringName (name)))
+                { std::fprintf (stderr, "cannot open %s\n", name.toRawUTF8());
+                  return 1; }
+            Stream::setParameter (*ring.getHeader(), index, value);
+        }
+        return 0;
+    }
+    //--------------------------------------------------------------------------
+    // test client
+    //--------------------------------------------------------------------------
+    if (client.isNotEmpty())
+    {
+        Stream::TestClient::Result r;
+        const bool ok = Stream::TestClient::run (ringName (client), seconds, block, r);
+        print (client, r.latency);
+        std::printf ("%s: %lld frames, output peak %.3f, %s\n", client.toRawUTF8(),
+                     (long long) r.frames, r.outputPeak,
+                     (ok && r.finite) ? "OK" : "FAILED");
+        return (ok && r.finite) ? 0 : 1;
+    }
+    //--------------------------------------------------------------------------
+    // daemon
+    //--------------------------------------------------------------------------
+    if (streams.isEmpty()) { std::fprintf (stderr, "no --stream given\n"); return 1; }
+    //--------------------------------------------------------------------------
+    OwnedArray<Stream::StreamWorker<double>> workers;
+    StringArray names;  // without the format suffix
+    for (int i = 0; i < streams.size(); ++i)
+    {
+        const String name = streams[i].upToFirstOccurrenceOf (":", false, false);
+        names.add (name);
+        const String fmt  = streams[i].fromFirstOccurrenceOf (":", false, false);
+        const SampleFormat format = (fmt == "int24") ? int24Format
+                                  : (fmt == "int16") ? int16Format : float32Format;
+        //----------------------------------------------------------------------
+        Stream::StreamWorker<double>* w = new Stream::StreamWorker<double> (
+                                ringName (name), format, capacity, rate, block);
+        if (! w->isValid ()) { std::fprintf (stderr, "cannot create %s\n",
+                                             name.toRawUTF8());
+                               delete w; return 1; }
+        workers.add (w)->startThread (Thread::realtimeAudioPriority);
+    }
+    //--------------------------------------------------------------------------
+    std::signal (SIGINT, stop);
+    std::signal (SIGTERM, stop);
+    while (running)
+    {
+        Thread::sleep (1000);
+        for (int i = 0; i < workers.size(); ++i)
+            print (names[i], workers[i]->getLatency ());
+    }
+    return 0;
+}
+//==============================================================================
@@ -2,23 +2,97 @@
 #include "Wavechild670Editor.h"
 #include "Wavechild670Processor.h"
 //==============================================================================
+namespace
+{
+    const int refreshHz = 30;
+    const float capFullScale = 10.0f;   // level cap volts at full meter scale
+    const float fallPerFrame = 0.85f;   // peak fall-back per refresh
+    //--------------------------------------------------------------------------
+    inline float dbFraction (float x) // -60 .. 0 dBFS
+    {
+        const float db = (x > 1e-6f) ? 20.0f * std::log10 (x) : -120.0f;
+        return jlimit (0.0f, 1.0f, (db + 60.0f) / 60.0f);
+    }
+}
+//==============================================================================
 Wavechild670Editor::Wavechild670Editor (Wavechild670Processor* ownerFilter)
     : AudioProcessorEditor (ownerFilter),
-      processor (ownerFilter)
+      processor (ownerFilter),
+      iterations (0.0f)
 {
+    for (int c = 0; c < 2; ++c) cap[c] = capHold[c] = peakIn[c] = peakOut[c] = 0.0f;
     setSize (400, 300);
+    startTimer (1000 / refreshHz);
 }
 //------------------------------------------------------------------------------
 Wavechild670Editor::~Wavechild670Editor()
 {
+    stopTimer ();
 }
 //------------------------------------------------------------------------------
 void Wavechild670Editor::resized ()
 {
 }
 //------------------------------------------------------------------------------
+// one meter frame per refresh: everything since the previous read is folded
+// in it, the decay is applied here (the audio thread never waits for us)
+//------------------------------------------------------------------------------
+void Wavechild670Editor::timerCallback ()
+{
+    Wavechild670::MeterFrame f;
+    const bool fresh = processor->getMeter().read (f);
+    for (int c = 0; c < 2; ++c)
+    {
+        const float k = fresh ? 1.0f : 0.0f;
+        cap[c]     = fresh ? f.cap[c] : cap[c];
+        capHold[c] = jmax (capHold[c] * fallPerFrame, k * f.capMax[c]);
+        peakIn[c]  = jmax (peakIn[c]  * fallPerFrame, k * f.peakIn[c]);
+        peakOut[c] = jmax (peakOut[c] * fallPerFrame, k * f.peakOut[c]);
+    }
+    if (fresh) iterations = f.iterations;
+    repaint ();
+}
+//------------------------------------------------------------------------------
+void Wavechild670Editor::paintMeter (Graphics& g, const Rectangle<int>& r,
+                                     const String& name, float fraction,
+                                     float hold, const String& text)
+{
+    g.setColour (Colours::darkgrey);
+    g.fillRect (r);
+    g.setColour (Colours::orange);
+    g.fillRect (r.withWidth (roundToInt (r.getWidth() * jlimit (0.0f, 1.0f, fraction))));
+    g.setColour (Colours::white);
+    g.fillRect (r.getX() + roundToInt (r.getWidth() * jlimit (0.0f, 1.0f, hold)),
+                r.getY(), 2, r.getHeight());
+    g.drawText (name + "  " + text, r.reduced (4, 0), Justification::centredLeft, false);
+}
+//------------------------------------------------------------------------------
 void Wavechild670Editor::paint (Graphics& g)
 {
     g.fillAll (Colours::black);
+    //--------------------------------------------------------------------------
+    Rectangle<int> area = getLocalBounds().reduced (20);
+    const int h = 24, gap = 10;
+    const char* channel[2] = { "A", "B" };
+    for (int c = 0; c < 2; ++c)
+    {
+        paintMeter (g, area.removeFromTop (h), String ("GR ") + channel[c],
+                    cap[c] / capFullScale, capHold[c] / capFullScale,
+                    String (cap[c], 2) + " V");
+        area.removeFromTop (gap);
+    }
+    for (int c = 0; c < 2; ++c)
+    {
+        paintMeter (g, area.removeFromTop (h), String ("In ") + channel[c],
+                    dbFraction (peakIn[c]), dbFraction (peakIn[c]), String::empty);
+        area.removeFromTop (gap / 2);
+        paintMeter (g, area.removeFromTop (h), String ("Out ") + channel[c],
+                    dbFraction (peakOut[c]), dbFraction (peakOut[c]), String::empty);
+        area.removeFromTop (gap);
+    }
+    //--------------------------------------------------------------------------
+    g.setColour (Colours::grey);
+    g.drawText ("Newton " + String (iterations, 2) + " it/solve",
+                area.removeFromTop (h), Justification::centredLeft, false);
 }
 //==============================================================================
\ No newline at end of file
@@ -36,7 +36,8 @@
 //==============================================================================
 class Wavechild670Processor;
 //==============================================================================
-class Wavechild670Editor : public AudioProcessorEditor
+class Wavechild670Editor : public AudioProcessorEditor,
+                           private Timer
 {
     public:
         Wavechild670Editor (Wavechild670Processor* ownerFilter);
@@ -46,7 +47,16 @@ class Wavechild670Editor : public AudioProcessorEditor
         void paint (Graphics& g);
         //======================================================================
     private:
-        ScopedPointer<Wavechild670Processor> processor;
+        void timerCallback ();
+        void paintMeter (Graphics& g, const Rectangle<int>& r, const String& name,
+                         float fraction, float hold, const String& text);
+        //----------------------------------------------------------------------
+        Wavechild670Processor* processor; // owned by the host
+        //----------------------------------------------------------------------
+        // display side ballistics (decimated from the meter frames)
+        //----------------------------------------------------------------------
+        float cap[2], capHold[2], peakIn[2], peakOut[2];
+        float iterations;
         //======================================================================
 };
 //==============================================================================
@@ -0,0 +1,122 @@
+//==============================================================================
+/**
+    Wavechild670 engine scaling benchmark
+    -------------------------------------
+    Runs the same batch of instances through a ProcessingEngine at 1, 2, 4 ...
+    worker threads (up to --threads, 0 = every core) and prints, per thread
+    count, the real-time factor of the batch, the speedup and parallel
+    efficiency against one thread, the mean scheduling overhead per cycle
+    and the steals per cycle.
+
+        Wavechild670EngineBenchmark [--instances 32] [--threads 0]
+                                    [--block 512] [--seconds 2] [--rate 48000]
+                                    [--group 1] [--efficiency 0]
+
+    With --efficiency e (0..1), exits non-zero when the efficiency at the
+    largest thread count is below e.
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_ProcessingEngine.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+struct Result
+{
+    double seconds;     // wall time of the run
+    double overhead;    // mean per cycle (s)
+    double steals;      // mean per cycle
+};
+//------------------------------------------------------------------------------
+static Result run (int instances, int threads, int block, int cycles,
+                   double rate, int group)
+{
+    typedef ProcessingEngine<double>::Buffer Buffer;
+    ProcessingEngine<double> engine (instances, threads);
+    engine.setGroupSize (group);
+    engine.init (rate, block, false);
+    //--------------------------------------------------------------------------
+    // a different noise level per instance, same input at every thread count
+    //--------------------------------------------------------------------------
+    HeapBlock<float> input (2 * instances * block), work (2 * instances * block);
+    HeapBlock<Buffer> buffers (instances);
+    Random random (670);
+    for (int i = 0; i < 2 * instances * block; ++i)
+        input[i] = (random.nextFloat () * 2.0f - 1.0f)
+                 * (0.1f + 0.9f * (i / (2 * block)) / instances);
+    //--------------------------------------------------------------------------
+    Result r = { 0.0, 0.0, 0.0 };
+    const int64 t0 = Time::getHighResolutionTicks ();
+    for (int c = 0; c < cycles; ++c)
+    {
+        memcpy (work, input, 2 * instances * block * sizeof (float));
+        for (int i = 0; i < instances; ++i)
+        {
+            Buffer b = { work + 2 * i * block, work + (2 * i + 1) * block, block };
+            buffers[i] = b;
+        }
+        engine.process (buffers);
+        r.overhead += engine.getStats ().overhead;
+        r.steals += engine.getStats ().steals;
+    }
+    r.seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks () - t0);
+    r.overhead /= jmax (1, cycles);
+    r.steals /= jmax (1, cycles);
+    return r;
+}
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    int instances = 32, threads = 0, block = 512, group = 1;
+    double seconds = 2.0, rate = 48000.0, efficiency = 0.0;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--instances")  instances = val.getIntValue();
+        else if (opt == "--threads")    threads = val.getIntValue();
+        else if (opt == "--block")      block = val.getIntValue();
+        else if (opt == "--seconds")    seconds = val.getDoubleValue();
+        else if (opt == "--rate")       rate = val.getDoubleValue();
+        else if (opt == "--group")      group = val.getIntValue();
+        else if (opt == "--efficiency") efficiency = val.getDoubleValue();
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    instances = jmax (1, instances); block = jmax (1, block);
+    if (threads <= 0) threads = SystemStats::getNumCpus();
+    const int cycles = jmax (1, roundToInt (seconds * rate / block));
+    //--------------------------------------------------------------------------
+    std::printf ("%d instances, %d x %d samples at %g Hz, group %d\n",
+                 instances, cycles, block, rate, group);
+    std::printf ("threads  realtime  speedup  efficiency  overhead/cycle  steals/cycle\n");
+    //--------------------------------------------------------------------------
+    double single = 0.0, last = 1.0;
+    for (int t = 1; t <= threads; t = (t < threads && 2 * t > threads) ? threads : 2 * t)
+    {
+        const Result r = run (instances, t, block, cycles, rate, group);
+        if (t == 1) single = r.seconds;
+        const double speedup = single / r.seconds;
+        last = speedup / t;
+        std::printf ("%7d  %7.1fx  %6.2fx  %9.0f%%  %11.1f us  %12.2f\n", t,
+                     instances * cycles * block / rate / r.seconds, speedup,
+                     100.0 * last, r.overhead * 1e6, r.steals);
+        if (t == threads) break;
+    }
+    //--------------------------------------------------------------------------
+    if (last < efficiency)
+    {
+        std::printf ("efficiency %.0f%% below %.0f%%  FAILED\n", 100.0 * last,
+                     100.0 * efficiency);
+        return 1;
+    }
+    return 0;
+}
+//==============================================================================
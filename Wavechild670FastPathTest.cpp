@@ -0,0 +1,182 @@
+//==============================================================================
+/**
+    Wavechild670 fast path test
+    ---------------------------
+    Checks the solver shortcuts against the full solve and exits non-zero on
+    any failure:
+
+    - small-signal fast path: a SignalAmplifier with a linear tolerance runs
+      next to one that always solves (tight Newton tolerance) on the same
+      gate signal; the fast path has to be taken and the relative error of
+      the anode currents has to stay within a margin of the tolerance (the
+      second order Taylor term is an estimate, not a bound).
+    - below-threshold early-out: over a sweep of DC thresholds, quiet
+      tolerances, block peaks and pot voltages, whenever the SidechainAmplifier
+      skips its chain at the level cap floor of the peak, the bridge current
+      of the plain chain has to be under the quiet tolerance.
+
+        Wavechild670FastPathTest [--rate 48000] [--seconds 1] [--margin 10]
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_SidechainAmplifier.hpp"
+#include "f670l_SignalAmplifier.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+// the Governor tiers' linear tolerances, gate amplitudes and level caps
+//==============================================================================
+static const double linearTolerances[] = { 1e-6, 1e-5, 1e-4, 1e-3 };
+static const double gateAmplitudes[]   = { 0.001, 0.01, 0.1 };
+static const double levelCaps[]        = { 0.0, 2.0, 6.0 };
+//------------------------------------------------------------------------------
+// DC threshold settings (-1 = constructor default) and quiet tolerances (A)
+//------------------------------------------------------------------------------
+static const double dcThresholds[]     = { -1.0, -0.1, 0.0, 0.1, 0.5, 1.0 };
+static const double quietTolerances[]  = { 1e-12, 1e-9, 1e-6 };
+//==============================================================================
+static int linearFastPath (double rate, double seconds, double margin)
+{
+    int failures = 0;
+    const int numSamples = jmax (1, roundToInt (seconds * rate));
+    const int settle = numSamples / 2;
+    //--------------------------------------------------------------------------
+    for (double tol : linearTolerances)
+        for (double amplitude : gateAmplitudes)
+            for (double cap : levelCaps)
+            {
+                SignalAmplifier<double> fast (rate), full (rate);
+                fast.setSolverQuality (1e-12, 50, 12);
+                full.setSolverQuality (1e-12, 50, 12);
+                fast.setLinearTolerance (tol);
+                full.setLinearTolerance (0.0);
+                //--------------------------------------------------------------
+                double worst = 0.0;
+                const double w = 2.0 * double_Pi * 1000.0 / rate;
+                for (int n = 0; n < settle + numSamples; ++n)
+                {
+                    const double Vgate = amplitude * sin (w * n);
+                    fast.processTubes (Vgate, cap);
+                    full.processTubes (Vgate, cap);
+                    if (n < settle) continue;
+                    for (int side = 0; side < 2; ++side)
+                    {
+                        const double I = full.getCurrent (side);
+                        const double e = fabs (fast.getCurrent (side) - I);
+                        worst = jmax (worst, e / jmax (fabs (I), 1e-12));
+                    }
+                }
+                //--------------------------------------------------------------
+                const int64 linear = fast.getSolverStats().linear;
+                const bool ok = linear > 0 && worst <= margin * tol;
+                if (! ok) ++failures;
+                std::printf ("linear: tol %g gate %g cap %g: %lld fast samples,"
+                             " worst %.3g x tol%s\n", tol, amplitude, cap,
+                             (long long) linear, worst / tol,
+                             ok ? "" : (linear > 0 ? "  FAILED" : "  FAILED (not taken)"));
+            }
+    return failures;
+}
+//==============================================================================
+// the plain (not antialiased) chain up to the bridge current
+//==============================================================================
+template <typename T>
+class QuietProbe : public SidechainAmplifier<T>
+{
+    public:
+        QuietProbe (T Fs) : SidechainAmplifier<T> (Fs) {}
+        //----------------------------------------------------------------------
+        inline T bridgeCurrent (T Vp, T VlevelCap) const
+        {
+            const T Vs1 = this->threshold.f.f (Vp);
+            return this->bridge.f.f (fabs (this->drive.f.f (Vs1)) - VlevelCap);
+        }
+        //----------------------------------------------------------------------
+        bool skipped () const { return this->skipping; }
+        T getQuietTolerance () const { return this->quietTolerance; }
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+static int quietEarlyOut (double rate)
+{
+    enum { numPeaks = 64, numPots = 64 };
+    int failures = 0;
+    //--------------------------------------------------------------------------
+    for (double dc : dcThresholds)
+        for (double tol : quietTolerances)
+        {
+            QuietProbe<double> probe (rate);
+            if (dc >= -0.5) probe.parameters (1.0, dc);
+            probe.setQuietTolerance (tol);
+            //------------------------------------------------------------------
+            // the largest peak with a floor, then peaks up to it (a block is
+            // skipped at the floor of its peak, every |Vpot| <= peak)
+            //------------------------------------------------------------------
+            double top = 0.0;
+            for (double p = 1e-3; p < 100.0; p *= 1.05)
+                if (probe.quietFloor (p) < 1e29) top = p;
+            //------------------------------------------------------------------
+            int64 skips = 0;
+            double worst = 0.0;
+            for (int k = 0; k <= numPeaks; ++k)
+            {
+                const double peak = top * k / numPeaks;
+                const double floor = probe.quietFloor (peak);
+                if (floor >= 1e29) continue;
+                for (int n = -numPots; n <= numPots; ++n)
+                {
+                    const double Vp = peak * n / numPots;
+                    if (probe.quietFloor (fabs (Vp)) > floor)
+                    {
+                        ++failures;     // the floor has to grow with the peak
+                        std::printf ("quiet: dc %g tol %g: floor (%g) > floor (%g)"
+                                     "  FAILED\n", dc, tol, fabs (Vp), peak);
+                        continue;
+                    }
+                    for (double cap = floor; cap <= floor + 8.0; cap += 2.0)
+                    {
+                        probe.detect (Vp, cap);
+                        if (! probe.skipped ()) continue;
+                        ++skips;
+                        worst = jmax (worst, probe.bridgeCurrent (Vp, cap));
+                    }
+                }
+            }
+            //------------------------------------------------------------------
+            const bool ok = skips > 0 && worst < probe.getQuietTolerance ();
+            if (! ok) ++failures;
+            std::printf ("quiet: dc %g tol %g: %lld skips up to %g V,"
+                         " worst %.3g x tol%s\n", dc, tol, (long long) skips,
+                         top, worst / tol,
+                         ok ? "" : (skips > 0 ? "  FAILED" : "  FAILED (not taken)"));
+        }
+    return failures;
+}
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    double rate = 48000.0, seconds = 1.0, margin = 10.0;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rate")    rate = val.getDoubleValue();
+        else if (opt == "--seconds") seconds = val.getDoubleValue();
+        else if (opt == "--margin")  margin = val.getDoubleValue();
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    //--------------------------------------------------------------------------
+    const int failures = linearFastPath (rate, seconds, margin)
+                       + quietEarlyOut (rate);
+    std::printf ("fastpath: %d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+//==============================================================================
@@ -0,0 +1,83 @@
+//==============================================================================
+/**
+    Wavechild670 preview tier tool
+    ------------------------------
+    Characterizes the full model offline and reports the error budget of the
+    low-CPU preview tier derived from it.
+
+        Wavechild670Preview [--rate 48000] [--out model.bin]
+        Wavechild670Preview --in model.bin [--seconds 6]
+
+    Per (feedback, time constant) setting it prints the static-curve error,
+    the attack/release errors, the program null depth and gain-trace error,
+    and the cost of both models (ns/sample).
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_Preview.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    double rate = 48000.0, seconds = 6.0;
+    String in, out;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rate")    rate = val.getDoubleValue();
+        else if (opt == "--seconds") seconds = val.getDoubleValue();
+        else if (opt == "--in")      in = val;
+        else if (opt == "--out")     out = val;
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    //--------------------------------------------------------------------------
+    ScopedPointer<PreviewModel> model = new PreviewModel ();
+    if (in.isNotEmpty())
+    {
+        FileInputStream stream ((File (File::getCurrentWorkingDirectory().getChildFile (in))));
+        if (! stream.openedOk () || ! model->read (stream))
+            { std::fprintf (stderr, "cannot read %s\n", in.toRawUTF8()); return 1; }
+    }
+    else
+    {
+        std::printf ("characterizing at %.0f Hz...\n", rate);
+        characterize (*model, rate);
+    }
+    //--------------------------------------------------------------------------
+    if (out.isNotEmpty())
+    {
+        const File file = File::getCurrentWorkingDirectory().getChildFile (out);
+        file.deleteFile ();
+        FileOutputStream stream (file);
+        if (! stream.openedOk ())
+            { std::fprintf (stderr, "cannot write %s\n", out.toRawUTF8()); return 1; }
+        model->write (stream);
+    }
+    //--------------------------------------------------------------------------
+    std::printf ("fb tc  static(dB) attack release  null(dB) trace(dB)"
+                 "  full(ns) preview(ns)  speedup\n");
+    for (int fb = 0; fb < 2; ++fb)
+    {
+        for (int tc = 0; tc < PreviewModel::numSettings; ++tc)
+        {
+            const PreviewError e = measure (*model, fb, tc, seconds);
+            std::printf ("%2d %2d  %10.2f %5.0f%% %6.0f%%  %8.1f %9.2f"
+                         "  %8.0f %11.1f  %6.0fx\n", fb, tc + 1, e.staticDb,
+                         e.attack * 100.0, e.release * 100.0, e.nullDb,
+                         e.gainTraceDb, e.nsFull, e.nsPreview,
+                         e.nsFull / jmax (e.nsPreview, 1e-3));
+        }
+    }
+    return 0;
+}
+//==============================================================================
@@ -1,12 +1,21 @@
 //==============================================================================
+#define WAVECHILD670_REALTIME_CHECK_IMPLEMENTATION // with WAVECHILD670_REALTIME_CHECK=1
 #include "Wavechild670Processor.h"
 #include "Wavechild670Editor.h"
 //==============================================================================
 Wavechild670Processor::Wavechild670Processor ()
     : wc670s (new Wavechild670::StereoProcessor<double>()),
       isInit (false),
+      pipelined (false),
+      blockSize (0),
       Fs(0)
 {
+    wc670s->setMeter (&meter);
+    //--------------------------------------------------------------------------
+    const String path = SystemStats::getEnvironmentVariable ("WAVECHILD670_CAPTURE",
+                                                             String::empty);
+    if (path.isNotEmpty())
+        capture.start (File (path).getNonexistentSibling ()); // one per instance
 }
 //------------------------------------------------------------------------------
 Wavechild670Processor::~Wavechild670Processor ()
@@ -15,31 +24,65 @@ Wavechild670Processor::~Wavechild670Processor ()
 //==============================================================================
 void Wavechild670Processor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    if (!isInit || sampleRate != Fs)
+    if (!isInit || sampleRate != Fs || samplesPerBlock != blockSize)
     {
+        pipeline = nullptr;
         isInit = true;
-        wc670s->init (sampleRate);
+        wc670s->init (sampleRate, samplesPerBlock, false);
+        Wavechild670::warmStart (*wc670s); // cached warmup
+        stagedState.discard ();
+        if (governor == nullptr) governor = new Wavechild670::Governor<double> (*wc670s);
+        governor->reset ();
         Fs = sampleRate;
+        blockSize = samplesPerBlock;
     }
+    capture.prepare (sampleRate, samplesPerBlock);
+    //--------------------------------------------------------------------------
+    if (pipelined && pipeline == nullptr)
+    {
+        pipeline = new Wavechild670::PipelinedStereoProcessor<double> (*wc670s);
+        pipeline->prepare (samplesPerBlock);
+    }
+    if (!pipelined) pipeline = nullptr;
+    //--------------------------------------------------------------------------
+    setLatencySamples ((pipeline != nullptr) ? pipeline->getLatencySamples() : 0);
 }
 //------------------------------------------------------------------------------
 void Wavechild670Processor::releaseResources ()
 {
+    pipeline = nullptr;
+}
+//------------------------------------------------------------------------------
+void Wavechild670Processor::setPipelined (bool shouldBePipelined)
+{
+    pipelined = shouldBePipelined;
 }
 //==============================================================================
 void Wavechild670Processor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
 {
+    WAVECHILD670_REALTIME_SCOPE;
     int ni = getNumInputChannels();
     int no = getNumOutputChannels();
     if (ni == 2)
     {
         float *left = buffer.getSampleData(0, 0);
         float *right = buffer.getSampleData(1, 0);
-        int i=0; int max=buffer.getNumSamples();
-        for (;i<max;++i)
+        if (stagedState.isPending ()) // setStateInformation
         {
-            wc670s->process (&left[i], &right[i]);
+            if (pipeline != nullptr) pipeline->settle ();
+            stagedState.apply (*wc670s);
         }
+        if (capture.isRecording ())
+        {
+            float parameters[Wavechild670::numParameters];
+            for (int p = 0; p < Wavechild670::numParameters; ++p)
+                parameters[p] = getParameter (p);
+            capture.block (left, right, buffer.getNumSamples(), parameters);
+        }
+        governor->begin ();
+        if (pipeline != nullptr) pipeline->processBlock (left, right, buffer.getNumSamples());
+        else                     wc670s->processBlock (left, right, buffer.getNumSamples());
+        governor->end (buffer.getNumSamples());
     }
     int i = ni;
     for (; i < no; ++i)
@@ -63,7 +106,7 @@ const String Wavechild670Processor::getName() const
 //==============================================================================
 int Wavechild670Processor::getNumParameters()
 {
-    return 11;
+    return Wavechild670::numParameters;
 }
 //------------------------------------------------------------------------------
 float Wavechild670Processor::getParameter (int index)
@@ -91,25 +134,9 @@ float Wavechild670Processor::getParameter (int index)
 //------------------------------------------------------------------------------
 void Wavechild670Processor::setParameter (int index, float newValue)
 {
-    switch (index)
-    {
-        case  0: wc670s->levelA = newValue; break;
-        case  1: wc670s->thresholdA = newValue; break;
-        case  2: wc670s->parameters (int(newValue * 10.f), wc670s->tcB);
-        //----------------------------------------------------------------------
-        case  3: wc670s->levelB = newValue; break;
-        case  4: wc670s->thresholdB = newValue; break;
-        case  5: wc670s->parameters (wc670s->tcA, int(newValue * 10.f));
-        //----------------------------------------------------------------------
-        case  6: wc670s->feedback = (newValue > 0.5f) ? true : false; break;
-        case  7: wc670s->midside = (newValue > 0.5f) ? true : false; break;
-        case  8: wc670s->linked = (newValue > 0.5f) ? true : false; break;
-        //----------------------------------------------------------------------
-        case  9: wc670s->gain = newValue; break;
-        case 10: wc670s->hardclipout = (newValue > 0.5f) ? true : false;
-        //----------------------------------------------------------------------
-        default: break;
-    };
+    WAVECHILD670_REALTIME_SCOPE;
+    if (pipeline != nullptr) pipeline->setParameter (index, newValue); // next block
+    else                     Wavechild670::applyParameter (*wc670s, index, newValue);
 }
 //------------------------------------------------------------------------------
 const String Wavechild670Processor::getParameterName (int index)
@@ -221,16 +248,34 @@ void Wavechild670Processor::changeProgramName (int index, const String& newName)
 {
 }
 //==============================================================================
+// parameters (count + values) followed by the circuit warm-state snapshot
+//------------------------------------------------------------------------------
 void Wavechild670Processor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    MemoryOutputStream out (destData, false);
+    out.writeInt (getNumParameters());
+    for (int i = 0; i < getNumParameters(); ++i)
+        out.writeFloat (getParameter (i));
+    //--------------------------------------------------------------------------
+    if (isInit)
+    {
+        Wavechild670::Snapshot<double> snapshot;
+        snapshot.save (*wc670s);
+        snapshot.write (out);
+    }
 }
 //----------------------------------------------------------------------
 void Wavechild670Processor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    MemoryInputStream in (data, (size_t) sizeInBytes, false);
+    const int n = jmin (in.readInt(), getNumParameters());
+    for (int i = 0; i < n; ++i)
+        setParameter (i, in.readFloat());
+    //--------------------------------------------------------------------------
+    // the snapshot only matches a processor prepared with the same layout,
+    // it is applied by the audio thread at the start of the next block
+    //--------------------------------------------------------------------------
+    if (isInit && ! in.isExhausted())
+        stagedState.read (in);
 }
 //==============================================================================
\ No newline at end of file
@@ -35,6 +35,11 @@
 #include "../JuceLibraryCode/JuceHeader.h"
 //==============================================================================
 #include "f670l_StereoProcessor.hpp"
+#include "f670l_PipelinedProcessor.hpp"
+#include "f670l_Snapshot.hpp"
+#include "f670l_Governor.hpp"
+#include "f670l_Metering.hpp"
+#include "f670l_Capture.hpp"
 //==============================================================================
 class Wavechild670Editor;
 //==============================================================================
@@ -78,13 +83,39 @@ class Wavechild670Processor : public AudioProcessor
         void getStateInformation (MemoryBlock& destData);
         void setStateInformation (const void* data, int sizeInBytes);
         //======================================================================
+        // Two-stage pipelined execution (one block of latency), takes effect
+        // at the next prepareToPlay
+        //======================================================================
+        void setPipelined (bool shouldBePipelined);
+        //======================================================================
+        // CPU-budget governor (solver quality tier and load, for display)
+        //======================================================================
+        const Wavechild670::Governor<double>* getGovernor () const { return governor; }
+        //======================================================================
+        // Metering channel (editor side: read() from a timer)
+        //======================================================================
+        Wavechild670::Meter& getMeter () { return meter; }
+        //======================================================================
+        // Host callback capture for offline replay (Wavechild670Replay),
+        // also started at construction by WAVECHILD670_CAPTURE=<file>
+        //======================================================================
+        bool startCapture (const File& file) { return capture.start (file); }
+        void stopCapture () { capture.stop (); }
+        const Wavechild670::Capture::Recorder& getCapture () const { return capture; }
+        //======================================================================
     private:
         //======================================================================
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Wavechild670Processor)
         //======================================================================
+        Wavechild670::Meter meter; // outlives the processors
+        Wavechild670::Capture::Recorder capture;
         ScopedPointer<Wavechild670::StereoProcessor<double>> wc670s;
+        ScopedPointer<Wavechild670::PipelinedStereoProcessor<double>> pipeline;
+        ScopedPointer<Wavechild670::Governor<double>> governor;
+        Wavechild670::StagedSnapshot<double> stagedState; // setStateInformation
         double Fs;
-        bool isInit;
+        int blockSize;
+        bool isInit, pipelined;
         //======================================================================
 };
 //==============================================================================
@@ -0,0 +1,76 @@
+//==============================================================================
+/**
+    Wavechild670 real-time safety test
+    ----------------------------------
+    Runs Realtime::Harness over a StereoProcessor, with the capture recorder
+    logging every block, and exits non-zero on any violation (allocation,
+    lock or blocking call on the audio thread).
+
+        Wavechild670RealtimeTest [--rate 48000] [--block 256] [--blocks 4]
+
+    The checks need Linux and glibc: elsewhere the test reports that it was
+    skipped and exits with 77.
+**/
+//==============================================================================
+#if defined (__linux__) && ! defined (WAVECHILD670_REALTIME_CHECK)
+ #define WAVECHILD670_REALTIME_CHECK 1
+#endif
+#define WAVECHILD670_REALTIME_CHECK_IMPLEMENTATION
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_RealtimeSafety.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    double rate = 48000.0;
+    int block = 256, blocks = 4;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rate")   rate = val.getDoubleValue();
+        else if (opt == "--block")  block = val.getIntValue();
+        else if (opt == "--blocks") blocks = jmax (1, val.getIntValue());
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    //--------------------------------------------------------------------------
+    if (! WAVECHILD670_REALTIME_CHECK)
+    {
+        std::printf ("rtcheck: skipped (checks need Linux and glibc)\n");
+        return 77;
+    }
+    //--------------------------------------------------------------------------
+    StereoProcessor<double> processor;
+    processor.init (rate, block);
+    //--------------------------------------------------------------------------
+    const File log = File::getSpecialLocation (File::tempDirectory)
+                        .getChildFile ("Wavechild670RealtimeTest.w67c");
+    Capture::Recorder recorder;
+    if (! recorder.start (log))
+    {
+        std::fprintf (stderr, "cannot create %s\n", log.getFullPathName().toRawUTF8());
+        return 1;
+    }
+    recorder.prepare (rate, block);
+    //--------------------------------------------------------------------------
+    const int count = Realtime::Harness::run (processor, blocks, &recorder);
+    recorder.stop ();
+    log.deleteFile ();
+    //--------------------------------------------------------------------------
+    std::printf ("rtcheck: %d violation(s)%s%s%s%s\n", count,
+                 count ? ", first: " : "",
+                 count ? Realtime::getFirstViolation () : "",
+                 count ? " in " : "",
+                 count ? Realtime::getFirstViolationScope () : "");
+    return count ? 1 : 0;
+}
+//==============================================================================
@@ -0,0 +1,115 @@
+//==============================================================================
+/**
+    Wavechild670 accuracy versus speed harness
+    ------------------------------------------
+    Compares every fast mode with a high precision reference.
+
+        Wavechild670Regression [--rate 48000] [--golden dir] [--update 1]
+                               [--verify 1] [--oversampling 4]
+                               [--max-residual -40] [--max-drift -100]
+
+    Reference outputs are read from the golden directory (default: golden,
+    run from the source directory, the files are committed). A missing
+    golden file is a failure: --update 1 renders and writes them, to be
+    committed. --verify 1 re-renders them and fails when one drifted more
+    than --max-drift dB. Per stimulus and mode it prints the null residual,
+    THD delta, gain-trace error, ns/sample and the Newton iterations per
+    solve (mean, worst, then the histogram of iteration counts in percent
+    of the solves) and the share of samples taken by the small-signal fast
+    path. Exits non-zero when a golden file is missing or drifted, or when
+    the default mode nulls worse than --max-residual dB against the
+    reference (0 disables the check).
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_Regression.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    double rate = 48000.0, maxResidual = -40.0, maxDrift = -100.0;
+    int oversampling = 4;
+    bool update = false, verify = false;
+    File golden = File::getCurrentWorkingDirectory().getChildFile ("golden");
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rate")         rate = val.getDoubleValue();
+        else if (opt == "--golden")       golden = File::getCurrentWorkingDirectory().getChildFile (val);
+        else if (opt == "--update")       update = val.getIntValue() != 0;
+        else if (opt == "--verify")       verify = val.getIntValue() != 0;
+        else if (opt == "--oversampling") oversampling = val.getIntValue();
+        else if (opt == "--max-residual") maxResidual = val.getDoubleValue();
+        else if (opt == "--max-drift")    maxDrift = val.getDoubleValue();
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    if (update) golden.createDirectory ();
+    //--------------------------------------------------------------------------
+    Regression::Reference reference (rate, oversampling);
+    int failures = 0;
+    for (int k = 0; k < Regression::numStimuli; ++k)
+    {
+        const Regression::Stimulus& s = Regression::stimuli[k];
+        const int n = (int) (s.seconds * rate);
+        HeapBlock<float> x (n), ref (n), fresh (n);
+        Regression::synthesize (s, x, n, rate);
+        //----------------------------------------------------------------------
+        const File file = Regression::goldenFile (golden, s, rate);
+        if (update)
+        {
+            reference.render (s, ref, n);
+            if (! Regression::writeGolden (file, rate, ref, n))
+            {
+                std::fprintf (stderr, "cannot write %s\n",
+                              file.getFullPathName().toRawUTF8());
+                ++failures; continue;
+            }
+        }
+        else if (! Regression::readGolden (file, rate, ref, n))
+        {
+            std::fprintf (stderr, "%s: missing golden file %s (render it with"
+                          " --update 1 and commit it)\n", s.name,
+                          file.getFullPathName().toRawUTF8());
+            ++failures; continue;
+        }
+        else if (verify)
+        {
+            reference.render (s, fresh, n);
+            const double drift = Analysis::nullDepth (ref, fresh, n);
+            std::printf ("%s: golden drift %.1f dB\n", s.name, drift);
+            if (drift > maxDrift) ++failures;
+        }
+        //----------------------------------------------------------------------
+        std::printf ("%-10s %-18s %9s %9s %9s %9s %7s %5s %6s\n", s.name, "mode",
+                     "null(dB)", "dTHD(%)", "GR(dB)", "ns/smp", "it/slv", "worst", "lin(%)");
+        for (int m = 0; m < Regression::numModes; ++m)
+        {
+            const Regression::Mode& mode = Regression::modes[m];
+            const Regression::Result r = Regression::compare (mode, s, x, ref, n, rate);
+            const SolverStats& st = r.solver;
+            std::printf ("%-10s %-18s %9.1f %9.4f %9.3f %9.0f %7.2f %5d %6.1f\n", "", mode.name,
+                         r.residualDb, r.thdDelta, r.grErrorDb, r.nsPerSample,
+                         (double) st.iterations / jmax ((int64) 1, st.solves), st.worst,
+                         100.0 * st.linear / jmax ((int64) 1, st.linear + st.solves));
+            //------------------------------------------------------------------
+            std::printf ("%-29s", "");
+            for (int k = 0; k <= st.worst && k < SolverStats::histogramSize; ++k)
+                std::printf (" %d:%.1f", k, 100.0 * st.histogram[k] / jmax ((int64) 1, st.solves));
+            std::printf ("\n");
+            if (m == 0 && maxResidual < 0.0 && r.residualDb > maxResidual) ++failures;
+        }
+    }
+    return failures ? 1 : 0;
+}
+//==============================================================================
+
@@ -0,0 +1,114 @@
+//==============================================================================
+/**
+    Wavechild670 offline renderer
+    -----------------------------
+    Processes an audio file through the limiter, optionally profiled.
+
+        Wavechild670Render --in input.wav --out output.wav [--tc 2]
+                           [--block 512] [--feedback 1] [--trace trace.json]
+
+    --trace writes the per-stage block profile as Chrome trace / Perfetto
+    JSON (open it in chrome://tracing or ui.perfetto.dev) and prints the
+    share of each stage.
+**/
+//==============================================================================
+#define WAVECHILD670_PROFILE 1
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_StereoProcessor.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    String in, out, trace;
+    int tc = 2, block = 512;
+    bool feedback = false;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--in")       in = val;
+        else if (opt == "--out")      out = val;
+        else if (opt == "--tc")       tc = val.getIntValue();
+        else if (opt == "--block")    block = val.getIntValue();
+        else if (opt == "--feedback") feedback = val.getIntValue() != 0;
+        else if (opt == "--trace")    trace = val;
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    if (in.isEmpty() || out.isEmpty())
+        { std::fprintf (stderr, "--in and --out are required\n"); return 1; }
+    //--------------------------------------------------------------------------
+    const File cwd = File::getCurrentWorkingDirectory();
+    AudioFormatManager formats;
+    formats.registerBasicFormats ();
+    ScopedPointer<AudioFormatReader> reader (formats.createReaderFor (cwd.getChildFile (in)));
+    if (reader == nullptr)
+        { std::fprintf (stderr, "cannot read %s\n", in.toRawUTF8()); return 1; }
+    //--------------------------------------------------------------------------
+    const int n = (int) reader->lengthInSamples;
+    AudioSampleBuffer buffer (2, n);
+    reader->read (&buffer, 0, n, 0, true, true);
+    const double Fs = reader->sampleRate;
+    //--------------------------------------------------------------------------
+    ScopedPointer<Profiling::Profiler> profiler (new Profiling::Profiler ());
+    StereoProcessor<double> processor;
+    processor.feedback = feedback;
+    processor.init (Fs, block);
+    processor.parameters (tc, tc);
+    if (trace.isNotEmpty()) processor.setProfiler (profiler);
+    //--------------------------------------------------------------------------
+    // drain the ring as we go (it holds Profiler::capacity blocks)
+    //--------------------------------------------------------------------------
+    Array<Profiling::BlockProfile> blocks;
+    HeapBlock<Profiling::BlockProfile> chunk (Profiling::Profiler::capacity);
+    float* left = buffer.getSampleData (0);
+    float* right = buffer.getSampleData (1);
+    for (int done = 0; done < n; done += block)
+    {
+        processor.processBlock (left + done, right + done, jmin (block, n - done));
+        const int m = profiler->read (chunk, Profiling::Profiler::capacity / 2);
+        for (int k = 0; k < m; ++k) blocks.add (chunk[k]);
+    }
+    //--------------------------------------------------------------------------
+    const File outFile = cwd.getChildFile (out);
+    outFile.deleteFile ();
+    ScopedPointer<FileOutputStream> stream (outFile.createOutputStream ());
+    WavAudioFormat wav;
+    ScopedPointer<AudioFormatWriter> writer (stream != nullptr
+        ? wav.createWriterFor (stream, Fs, 2, 24, StringPairArray(), 0) : nullptr);
+    if (writer == nullptr)
+        { std::fprintf (stderr, "cannot write %s\n", out.toRawUTF8()); return 1; }
+    stream.release ();
+    writer->writeFromAudioSampleBuffer (buffer, 0, n);
+    //--------------------------------------------------------------------------
+    if (trace.isNotEmpty())
+    {
+        const File traceFile = cwd.getChildFile (trace);
+        traceFile.deleteFile ();
+        FileOutputStream json (traceFile);
+        Profiling::writeChromeTrace (json, blocks.getRawDataPointer(), blocks.size());
+        //----------------------------------------------------------------------
+        uint64 total = 0, stage[Profiling::numStages] = { 0 };
+        for (int b = 0; b < blocks.size(); ++b)
+        {
+            total += blocks[b].end - blocks[b].start;
+            for (int s = 0; s < Profiling::numStages; ++s) stage[s] += blocks[b].stage[s];
+        }
+        const double ns = 1e9 / Profiling::ticksPerSecond () / jmax (1, n);
+        std::printf ("%d blocks, %.0f ns/sample (%d dropped)\n", blocks.size(),
+                     total * ns, profiler->getDropped ());
+        for (int s = 0; s < Profiling::numStages; ++s)
+            std::printf ("  %-20s %8.0f ns/sample %5.1f%%\n", Profiling::stageName (s),
+                         stage[s] * ns, 100.0 * stage[s] / jmax ((uint64) 1, total));
+    }
+    return 0;
+}
+//==============================================================================
@@ -0,0 +1,135 @@
+//==============================================================================
+/**
+    Wavechild670 capture replay
+    ---------------------------
+    Feeds a host callback capture (see f670l_Capture.hpp, recorded by the
+    plugin with WAVECHILD670_CAPTURE=<file>) to the limiter, block by block
+    as the host did, and reports where the time goes.
+
+        Wavechild670Replay --in capture.w67c [--runs 3] [--top 10]
+                           [--csv blocks.csv]
+
+    Every block keeps its best time over the runs; the solver path of a
+    capture does not depend on timing, so the runs must take the same
+    Newton iterations (checked). Prints the totals, then the blocks with
+    the highest load (processing time over the block duration) with their
+    position in the capture and their solver statistics. --csv writes one
+    line per block.
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_Capture.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+static double load (const Capture::BlockTiming& b)
+{
+    return b.seconds * b.Fs / jmax (1, b.numSamples);
+}
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    String in, csv;
+    int runs = 3, top = 10;
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--in")   in = val;
+        else if (opt == "--runs") runs = jmax (1, val.getIntValue());
+        else if (opt == "--top")  top = val.getIntValue();
+        else if (opt == "--csv")  csv = val;
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    if (in.isEmpty())
+        { std::fprintf (stderr, "--in is required\n"); return 1; }
+    //--------------------------------------------------------------------------
+    const File cwd = File::getCurrentWorkingDirectory();
+    const File file = cwd.getChildFile (in);
+    Array<Capture::BlockTiming> best;
+    Capture::Summary summary;
+    bool identical = true;
+    for (int r = 0; r < runs; ++r)
+    {
+        Array<Capture::BlockTiming> blocks;
+        if (! Capture::replay<double> (file, blocks, summary))
+            { std::fprintf (stderr, "cannot read %s\n", in.toRawUTF8()); return 1; }
+        if (r == 0) { best = blocks; continue; }
+        for (int k = 0; k < best.size(); ++k)
+        {
+            Capture::BlockTiming& b = best.getReference (k);
+            b.seconds = jmin (b.seconds, blocks[k].seconds);
+            identical = identical && b.solver.iterations == blocks[k].solver.iterations
+                                  && b.solver.linear == blocks[k].solver.linear;
+        }
+    }
+    //--------------------------------------------------------------------------
+    double audio = 0.0, cpu = 0.0;
+    int64 samples = 0;
+    SolverStats solver;
+    for (int k = 0; k < best.size(); ++k)
+    {
+        const Capture::BlockTiming& b = best.getReference (k);
+        audio += b.numSamples / b.Fs; cpu += b.seconds;
+        samples += b.numSamples;
+        solver.add (b.solver);
+    }
+    std::printf ("%s: %d blocks, %.1f s of audio, %d prepare, %d parameter, "
+                 "%d gaps (%lld samples dropped)\n", in.toRawUTF8(), best.size(),
+                 audio, summary.prepares, summary.parameters, summary.gaps,
+                 (long long) summary.gapSamples);
+    std::printf ("best of %d: %.0f ns/sample, %.1f%% of real time, %.2f it/slv, "
+                 "solver path %s\n", runs, cpu * 1e9 / jmax ((int64) 1, samples),
+                 100.0 * cpu / jmax (1e-9, audio),
+                 solver.iterations / jmax (1.0, (double) solver.solves),
+                 identical ? "identical across runs" : "DIFFERS between runs");
+    //--------------------------------------------------------------------------
+    // highest load first
+    //--------------------------------------------------------------------------
+    Array<int> order;
+    for (int k = 0; k < best.size(); ++k)
+    {
+        int at = 0;
+        while (at < order.size() && load (best[order[at]]) >= load (best[k])) ++at;
+        if (at < top) order.insert (at, k);
+        if (order.size() > top) order.removeLast ();
+    }
+    std::printf ("%8s %10s %6s %9s %7s %6s %5s %6s\n", "block", "time (s)", "n",
+                 "us", "load", "it/slv", "worst", "lin(%)");
+    for (int i = 0; i < order.size(); ++i)
+    {
+        const Capture::BlockTiming& b = best.getReference (order[i]);
+        const int64 total = b.solver.solves + b.solver.linear;
+        std::printf ("%8d %10.3f %6d %9.1f %6.1f%% %6.2f %5d %6.1f\n", order[i],
+                     b.position / b.Fs, b.numSamples, b.seconds * 1e6,
+                     100.0 * load (b),
+                     b.solver.iterations / jmax (1.0, (double) b.solver.solves),
+                     b.solver.worst, 100.0 * b.solver.linear / jmax ((int64) 1, total));
+    }
+    //--------------------------------------------------------------------------
+    if (csv.isNotEmpty())
+    {
+        const File csvFile = cwd.getChildFile (csv);
+        csvFile.deleteFile ();
+        FileOutputStream out (csvFile);
+        out << "block,position,samples,rate,seconds,load,solves,iterations,worst,linear\n";
+        for (int k = 0; k < best.size(); ++k)
+        {
+            const Capture::BlockTiming& b = best.getReference (k);
+            out << k << "," << b.position << "," << b.numSamples << ","
+                << b.Fs << "," << b.seconds << "," << load (b) << ","
+                << b.solver.solves << "," << b.solver.iterations << ","
+                << b.solver.worst << "," << b.solver.linear << "\n";
+        }
+    }
+    return 0;
+}
+//==============================================================================
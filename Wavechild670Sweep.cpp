@@ -0,0 +1,88 @@
+//==============================================================================
+/**
+    Wavechild670 parameter sweep
+    ----------------------------
+    Characterizes the limiter over a grid of settings on all cores.
+
+        Wavechild670Sweep [--rates 44100,48000,96000] [--levels 0.25,0.5,0.75,1]
+                          [--tc 0,1,2,3,4,5] [--instances 0] [--threads 0]
+                          [--out sweep.w67s]
+
+    Every combination of rate, input level, time constant, feedback and
+    link gets a row: attack/release of a -30/0 dB step, settled step gains,
+    the static curve (gain and THD from -36 to 0 dB) and the gain of the
+    quieter right channel at full scale. Results are written column by
+    column (see Sweep::Table). --instances is the number of processors run
+    per batch (0 = two per worker thread).
+**/
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+#include "f670l_Sweep.hpp"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//==============================================================================
+using namespace Wavechild670;
+//==============================================================================
+template <typename V>
+static void parseList (const String& val, Array<V>& list)
+{
+    StringArray tokens;
+    tokens.addTokens (val, ",", String::empty);
+    list.clear ();
+    for (int i = 0; i < tokens.size(); ++i)
+        list.add ((V) tokens[i].trim().getDoubleValue());
+}
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args;
+    for (int i = 1; i < argc; ++i) args.add (argv[i]);
+    //--------------------------------------------------------------------------
+    Sweep::Grid grid;
+    int instances = 0, threads = 0;
+    File out = File::getCurrentWorkingDirectory().getChildFile ("sweep.w67s");
+    //--------------------------------------------------------------------------
+    for (int i = 0; i + 1 < args.size(); i += 2)
+    {
+        const String& opt = args[i];
+        const String& val = args[i + 1];
+        if      (opt == "--rates")     parseList (val, grid.rates);
+        else if (opt == "--levels")    parseList (val, grid.levels);
+        else if (opt == "--tc")        parseList (val, grid.timeConstants);
+        else if (opt == "--instances") instances = val.getIntValue();
+        else if (opt == "--threads")   threads = val.getIntValue();
+        else if (opt == "--out")       out = File::getCurrentWorkingDirectory().getChildFile (val);
+        else { std::fprintf (stderr, "unknown option %s\n", opt.toRawUTF8());
+               return 1; }
+    }
+    if (grid.numPoints () == 0) { std::fprintf (stderr, "empty grid\n"); return 1; }
+    //--------------------------------------------------------------------------
+    if (threads <= 0) threads = SystemStats::getNumCpus();
+    if (instances <= 0) instances = 2 * threads;
+    Sweep::Runner runner (grid, instances, threads);
+    Sweep::Table table (grid.numPoints ());
+    //--------------------------------------------------------------------------
+    const int64 t0 = Time::getHighResolutionTicks ();
+    for (int k = 0; k < grid.rates.size(); ++k)
+    {
+        const int64 t1 = Time::getHighResolutionTicks ();
+        runner.run (k, table);
+        const double t = Time::highResolutionTicksToSeconds (
+                             Time::getHighResolutionTicks () - t1);
+        std::printf ("%8.0f Hz: %d points in %.1f s (%d workers)\n",
+                     grid.rates[k], grid.pointsPerRate (), t, runner.getNumWorkers ());
+    }
+    std::printf ("total %.1f s\n", Time::highResolutionTicksToSeconds (
+                                       Time::getHighResolutionTicks () - t0));
+    //--------------------------------------------------------------------------
+    if (! table.write (out))
+    {
+        std::fprintf (stderr, "cannot write %s\n", out.getFullPathName().toRawUTF8());
+        return 1;
+    }
+    std::printf ("%d rows x %d columns -> %s\n", table.numRows, (int) Sweep::numColumns,
+                 out.getFullPathName().toRawUTF8());
+    return 0;
+}
+//==============================================================================
@@ -0,0 +1,285 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_ANALYSIS_HPP_58E0B3A7__
+#define __F670L_ANALYSIS_HPP_58E0B3A7__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+namespace Wavechild670 {
+namespace Analysis {
+//==============================================================================
+// Offline measurement helpers
+//------------------------------------------------------------------------------
+// Every processor P used here has the StereoProcessor block API:
+//
+//      void init (double Fs, int maxBlockSize);
+//      void parameters (int tcA, int tcB);
+//      void processBlock (float* left, float* right, int numSamples);
+//
+// Measurements feed a mono signal to both channels and read the left one.
+//==============================================================================
+static inline double toDb (double gain) { return 20.0 * log10 (jmax (gain, 1e-20)); }
+static inline double fromDb (double dB) { return pow (10.0, dB / 20.0); }
+//------------------------------------------------------------------------------
+static void tone (float* x, int n, double freq, double Fs, double amplitude,
+                  int64 offset = 0)
+{
+    const double w = 2.0 * double_Pi * freq / Fs;
+    for (int i = 0; i < n; ++i) x[i] = (float) (amplitude * cos (w * (offset + i)));
+}
+//------------------------------------------------------------------------------
+static double rms (const float* x, int n)
+{
+    double s = 0.0;
+    for (int i = 0; i < n; ++i) s += (double) x[i] * x[i];
+    return (n > 0) ? sqrt (s / n) : 0.0;
+}
+//------------------------------------------------------------------------------
+// complex amplitude at freq (cos reference), over a whole number of periods
+//------------------------------------------------------------------------------
+static void goertzel (const float* x, int n, double freq, double Fs,
+                      double& re, double& im)
+{
+    const int periods = (int) (n * freq / Fs);
+    if (periods > 0) n = (int) (periods * Fs / freq);
+    const double w = 2.0 * double_Pi * freq / Fs;
+    re = im = 0.0;
+    for (int i = 0; i < n; ++i) { re += x[i] * cos (w*i); im -= x[i] * sin (w*i); }
+    re *= 2.0 / n; im *= 2.0 / n;
+}
+//------------------------------------------------------------------------------
+static double amplitude (const float* x, int n, double freq, double Fs)
+{
+    double re, im; goertzel (x, n, freq, Fs, re, im);
+    return sqrt (re*re + im*im);
+}
+//------------------------------------------------------------------------------
+// sqrt (sum of harmonic powers 2..numHarmonics) / fundamental
+//------------------------------------------------------------------------------
+static double harmonicDistortion (const float* x, int n, double freq, double Fs,
+                                  int numHarmonics = 7)
+{
+    const double a1 = amplitude (x, n, freq, Fs);
+    double h = 0.0;
+    for (int k = 2; k <= numHarmonics && k*freq < 0.5*Fs; ++k)
+    {
+        const double ak = amplitude (x, n, k*freq, Fs);
+        h += ak*ak;
+    }
+    return sqrt (h) / jmax (a1, 1e-20);
+}
+//==============================================================================
+// mono in, left out (in may alias out)
+//==============================================================================
+template <class P>
+static void render (P& p, const float* in, float* out, int n, int block)
+{
+    HeapBlock<float> l (block), r (block);
+    for (int done = 0; done < n;)
+    {
+        const int m = jmin (block, n - done);
+        memcpy (l, in + done, m * sizeof (float));
+        memcpy (r, in + done, m * sizeof (float));
+        p.processBlock (l, r, m);
+        memcpy (out + done, l, m * sizeof (float));
+        done += m;
+    }
+}
+//==============================================================================
+// Steady-state response to a tone: signed fundamental gain and harmonics
+// 2..numHarmonics relative to the fundamental (signed as a static
+// waveshaper would produce them, i.e. in phase with cos (k.theta))
+//==============================================================================
+struct ToneResponse
+{
+    double gain;                // output / input fundamental (signed)
+    double harmonic[8];         // [k] for k = 2..7, relative to fundamental
+    double thd;                 // sqrt (sum h_k^2)
+};
+//------------------------------------------------------------------------------
+template <class P>
+static ToneResponse toneResponse (P& p, double Fs, double level, double freq = 1000.0,
+                                  double settle = 1.5, double window = 0.2,
+                                  int block = 512, int numHarmonics = 7)
+{
+    const int ns = (int) (settle * Fs), nw = (int) (window * Fs);
+    HeapBlock<float> x (ns + nw), y (ns + nw);
+    tone (x, ns + nw, freq, Fs, level);
+    render (p, x, y, ns + nw, block);
+    //--------------------------------------------------------------------------
+    ToneResponse r;
+    double re, im; goertzel (y + ns, nw, freq, Fs, re, im);
+    //--------------------------------------------------------------------------
+    // the window starts at input phase w0: psi = phase shift of the chain,
+    // an inversion (|psi| > pi/2) goes into the sign of the gain
+    //--------------------------------------------------------------------------
+    const double w0 = 2.0 * double_Pi * freq / Fs * ns;
+    const double a1 = sqrt (re*re + im*im), psi = atan2 (im, re) - w0;
+    const bool inverted = cos (psi) < 0.0;
+    const double shift = inverted ? psi - double_Pi : psi;
+    r.gain = (inverted ? -a1 : a1) / level;
+    r.thd = 0.0;
+    for (int k = 0; k < 8; ++k) r.harmonic[k] = 0.0;
+    for (int k = 2; k <= jmin (7, numHarmonics); ++k)
+    {
+        goertzel (y + ns, nw, k*freq, Fs, re, im);
+        const double ak = sqrt (re*re + im*im) / jmax (a1, 1e-20);
+        const double pk = atan2 (im, re) - k*w0 - k*shift;
+        r.harmonic[k] = ((cos (pk) < 0.0) != inverted) ? -ak : ak;
+        r.thd += ak*ak;
+    }
+    r.thd = sqrt (r.thd);
+    return r;
+}
+//==============================================================================
+// Gain trace of a level step (low -> high -> low), short-window RMS ratio.
+// Attack and release are the times to 63% of the gain change.
+//==============================================================================
+struct StepResponse
+{
+    double attack, release;     // seconds
+    double lowGain, highGain;   // settled gains (dB)
+};
+//------------------------------------------------------------------------------
+// attack/release of an already rendered step: x holds n1 low, n2 high and
+// n3 low samples of a tone, y the matching output
+//------------------------------------------------------------------------------
+static StepResponse stepAnalysis (const float* x, const float* y,
+                                  int n1, int n2, int n3, double Fs,
+                                  double freq = 1000.0)
+{
+    const int n = n1 + n2 + n3, win = jmax (1, (int) (Fs / freq) * 2);
+    const int frames = n / win;
+    HeapBlock<double> g (frames);
+    for (int f = 0; f < frames; ++f)
+        g[f] = toDb (rms (y + f*win, win) / jmax (rms (x + f*win, win), 1e-20));
+    //--------------------------------------------------------------------------
+    StepResponse s;
+    const int f1 = n1 / win, f2 = (n1 + n2) / win;
+    s.lowGain  = g[jmax (0, f1 - 2)];
+    s.highGain = g[jmax (0, f2 - 2)];
+    s.attack = s.release = 0.0;
+    //--------------------------------------------------------------------------
+    const double aTarget = s.lowGain + 0.63 * (s.highGain - s.lowGain);
+    for (int f = f1; f < f2; ++f)
+        if ((s.highGain < s.lowGain) ? g[f] <= aTarget : g[f] >= aTarget)
+            { s.attack = (f - f1) * (double) win / Fs; break; }
+    //--------------------------------------------------------------------------
+    const double rTarget = s.highGain + 0.63 * (g[frames - 1] - s.highGain);
+    s.release = n3 / Fs;
+    for (int f = f2; f < frames; ++f)
+        if ((s.highGain < s.lowGain) ? g[f] >= rTarget : g[f] <= rTarget)
+            { s.release = (f - f2) * (double) win / Fs; break; }
+    return s;
+}
+//------------------------------------------------------------------------------
+template <class P>
+static StepResponse stepResponse (P& p, double Fs, double low, double high,
+                                  double hold = 1.0, double tail = 4.0,
+                                  double freq = 1000.0, int block = 512)
+{
+    const int n1 = (int) (hold * Fs), n2 = (int) (hold * Fs), n3 = (int) (tail * Fs);
+    const int n = n1 + n2 + n3;
+    HeapBlock<float> x (n), y (n);
+    tone (x, n, freq, Fs, 1.0);
+    for (int i = 0; i < n; ++i) x[i] *= (float) ((i >= n1 && i < n1 + n2) ? high : low);
+    render (p, x, y, n, block);
+    return stepAnalysis (x, y, n1, n2, n3, Fs, freq);
+}
+//==============================================================================
+// Time per sample of a processor on a signal (ns), best of a few runs
+//==============================================================================
+template <class P>
+static double nanosecondsPerSample (P& p, const float* in, int n, int block,
+                                    int runs = 3)
+{
+    HeapBlock<float> y (n);
+    double best = 1e30;
+    for (int k = 0; k < runs; ++k)
+    {
+        const int64 t0 = Time::getHighResolutionTicks ();
+        render (p, in, y, n, block);
+        const double t = Time::highResolutionTicksToSeconds (
+                             Time::getHighResolutionTicks () - t0);
+        best = jmin (best, t);
+    }
+    return best * 1e9 / jmax (1, n);
+}
+//==============================================================================
+// Program-like test signal: two tones under a stepped, ramped envelope
+// spanning the gain-reduction range
+//==============================================================================
+static void programSignal (float* x, int n, double Fs, double low = 0.01,
+                           double high = 1.0)
+{
+    const double w1 = 2.0 * double_Pi * 220.0 / Fs, w2 = 2.0 * double_Pi * 1870.0 / Fs;
+    const int segment = jmax (1, (int) (0.35 * Fs));
+    for (int i = 0; i < n; ++i)
+    {
+        const int s = i / segment;
+        const double u = (double) ((s * 7) % 11) / 10.0;       // 0 .. 1
+        const double env = low * pow (high / low, u);
+        x[i] = (float) (env * (0.7 * sin (w1*i) + 0.3 * sin (w2*i)));
+    }
+}
+//==============================================================================
+// Residual of b against a (reference): RMS error relative to RMS of a (dB)
+//==============================================================================
+static double nullDepth (const float* a, const float* b, int n)
+{
+    double e = 0.0, s = 0.0;
+    for (int i = 0; i < n; ++i) { const double d = (double) b[i] - a[i];
+                                  e += d*d; s += (double) a[i]*a[i]; }
+    return 10.0 * log10 (jmax (e, 1e-30) / jmax (s, 1e-30));
+}
+//==============================================================================
+// RMS difference of the short-window gain traces of two outputs (dB)
+//==============================================================================
+static double gainTraceError (const float* in, const float* a, const float* b,
+                              int n, int win)
+{
+    double e = 0.0; int count = 0;
+    for (int i = 0; i + win <= n; i += win)
+    {
+        const double xi = rms (in + i, win);
+        if (xi < 1e-6) continue;
+        const double d = toDb (rms (b + i, win) / xi) - toDb (rms (a + i, win) / xi);
+        e += d*d; ++count;
+    }
+    return (count > 0) ? sqrt (e / count) : 0.0;
+}
+//==============================================================================
+} // namespace Analysis
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_ANALYSIS_HPP_58E0B3A7__
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,152 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_ARENA_HPP_7E2B19D4__
+#define __F670L_ARENA_HPP_7E2B19D4__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Per-instance storage
+//------------------------------------------------------------------------------
+// A bump allocator over a block the caller owns (a ProcessingEngine slot),
+// every allocation rounded up to whole cache lines, so the state of two
+// instances never shares a line. Placed<Object> builds its object in an
+// arena when there is one with room, else on the heap.
+//==============================================================================
+class Arena
+{
+    public:
+        enum { cacheLineSize = 64 };
+        //----------------------------------------------------------------------
+        Arena () : base (nullptr), size (0), used (0) {}
+        //----------------------------------------------------------------------
+        static size_t round (size_t bytes)
+        {
+            return (bytes + cacheLineSize - 1) & ~(size_t) (cacheLineSize - 1);
+        }
+        //----------------------------------------------------------------------
+        static char* align (void* p)
+        {
+            return (char*) (((pointer_sized_int) p + cacheLineSize - 1)
+                            & ~(pointer_sized_int) (cacheLineSize - 1));
+        }
+        //----------------------------------------------------------------------
+        // block: cache line aligned, bytes: a multiple of cacheLineSize
+        //----------------------------------------------------------------------
+        void assign (void* block, size_t bytes)
+        {
+            jassert (block == align (block));
+            base = (char*) block; size = bytes; used = 0;
+        }
+        //----------------------------------------------------------------------
+        // nullptr when full (the caller falls back to the heap)
+        //----------------------------------------------------------------------
+        void* allocate (size_t bytes)
+        {
+            if (base == nullptr || used + round (bytes) > size) return nullptr;
+            void* p = base + used;
+            used += round (bytes);
+            return p;
+        }
+        //----------------------------------------------------------------------
+        // every object built in the arena has been destroyed
+        //----------------------------------------------------------------------
+        void clear () { used = 0; }
+        //----------------------------------------------------------------------
+    private:
+        char* base;
+        size_t size, used;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Arena)
+};
+//==============================================================================
+template <class Object>
+class Placed
+{
+    public:
+        Placed () : object (nullptr), inArena (false) {}
+        ~Placed () { reset (); }
+        //----------------------------------------------------------------------
+        void create (Arena* arena)
+        {
+            reset ();
+            void* p = place (arena);
+            object = (p != nullptr) ? new (p) Object () : new Object ();
+        }
+        //----------------------------------------------------------------------
+        template <typename Arg>
+        void create (Arena* arena, const Arg& arg)
+        {
+            reset ();
+            void* p = place (arena);
+            object = (p != nullptr) ? new (p) Object (arg) : new Object (arg);
+        }
+        //----------------------------------------------------------------------
+        template <typename Arg1, typename Arg2>
+        void create (Arena* arena, const Arg1& arg1, const Arg2& arg2)
+        {
+            reset ();
+            void* p = place (arena);
+            object = (p != nullptr) ? new (p) Object (arg1, arg2)
+                                    : new Object (arg1, arg2);
+        }
+        //----------------------------------------------------------------------
+        void reset ()
+        {
+            if (inArena) object->~Object ();
+            else         delete object;
+            object = nullptr; inArena = false;
+        }
+        //----------------------------------------------------------------------
+        inline Object* operator-> () const { return object; }
+        inline Object& operator* () const  { return *object; }
+        inline operator Object* () const   { return object; }
+        //----------------------------------------------------------------------
+    private:
+        Object* object;
+        bool inArena;
+        //----------------------------------------------------------------------
+        void* place (Arena* arena)
+        {
+            void* p = (arena != nullptr) ? arena->allocate (sizeof (Object)) : nullptr;
+            inArena = (p != nullptr);
+            return p;
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Placed)
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_ARENA_HPP_7E2B19D4__
+//==============================================================================
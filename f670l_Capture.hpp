@@ -0,0 +1,420 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+#ifndef __F670L_CAPTURE_HPP_3B9E05D1__
+#define __F670L_CAPTURE_HPP_3B9E05D1__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_Snapshot.hpp"
+//==============================================================================
+namespace Wavechild670 {
+namespace Capture {
+//==============================================================================
+// Host callback capture and replay
+//------------------------------------------------------------------------------
+// The Recorder logs what the host feeds the plugin, block by block: the
+// input buffers and their sizes, sample rate / maximum block size changes
+// and the parameter values the block was processed with. The audio thread
+// only copies records into a lock-free byte ring (one atomic load per block
+// when idle); a writer thread drains it to the file every 20 ms. When the
+// ring is full the block is dropped and a gap record tells how much audio
+// is missing, the audio thread never waits.
+//
+// Parameters are sampled by the audio thread at block boundaries (every
+// value on the first block, then the ones that changed): setParameter may
+// be called from any thread and that is when the circuit sees them.
+//
+// File (little endian): int32 magic 'W67C', int32 version, then records
+//
+//      'P' float64 Fs, int32 maximum block size       prepareToPlay
+//      'S' int32 index, float32 value                  parameter
+//      'B' int32 n, float32 left[n], float32 right[n]  input block
+//      'G' int32 blocks, int64 samples                 dropped input
+//
+// replay() feeds a capture to a fresh StereoProcessor (prepared like the
+// plugin: cold init and cached warm start) and times every block. The
+// circuit state at the start of the capture is not recorded, nor are the
+// governor decisions: the replay runs the default solver quality, so a
+// capture always takes the same solver path (Wavechild670Replay).
+//==============================================================================
+enum { magic = 0x57363743, version = 1 }; // 'W67C'
+//------------------------------------------------------------------------------
+enum RecordType
+{
+    prepareRecord   = 'P',
+    parameterRecord = 'S',
+    blockRecord     = 'B',
+    gapRecord       = 'G'
+};
+//==============================================================================
+// Recorder: start()/stop() from one control thread, prepare() with the
+// audio stopped (prepareToPlay), block() from the audio thread
+//==============================================================================
+class Recorder : private Thread
+{
+    public:
+        enum { capacity = 1 << 22 };    // bytes, ~10 s of 48 kHz stereo
+        //----------------------------------------------------------------------
+        Recorder ()
+            : Thread ("Wavechild670 capture writer"), fifo (capacity),
+              Fs (0.0), blockSize (0), sync (true), gapBlocks (0), gapSamples (0)
+        {
+            zeromem (last, sizeof (last));
+        }
+        //----------------------------------------------------------------------
+        ~Recorder ()
+        {
+            if (! stop ())
+            {
+                stopThread (-1);            // the members outlive the writer
+                stream = nullptr;
+            }
+        }
+        //----------------------------------------------------------------------
+        bool start (const File& f)
+        {
+            if (! stop ()) return false;
+            f.deleteFile ();
+            ScopedPointer<FileOutputStream> out (new FileOutputStream (f));
+            if (! out->openedOk ()) return false;
+            out->writeInt (magic); out->writeInt (version);
+            stream = out.release ();
+            //------------------------------------------------------------------
+            if (ring == nullptr) ring.malloc (capacity);
+            fifo.reset ();
+            written = 0; dropped = 0;
+            sync = true; gapBlocks = 0; gapSamples = 0;
+            prepared = 1;                       // resend the current setup
+            //------------------------------------------------------------------
+            startThread ();
+            active = 1;
+            return true;
+        }
+        //----------------------------------------------------------------------
+        // waits for a block in flight, then drains the ring and closes; the
+        // writer owns the stream until it has exited, so if it does not exit
+        // in time the stream stays open and false is returned
+        //----------------------------------------------------------------------
+        bool stop ()
+        {
+            active = 0;
+            while (busy.get () != 0) Thread::yield ();
+            signalThreadShouldExit ();
+            notify ();
+            if (! stopThread (5000)) return false;
+            stream = nullptr;
+            return true;
+        }
+        //----------------------------------------------------------------------
+        bool isRecording () const { return active.get () != 0; }
+        int64 getWritten () const { return written.get (); }     // bytes
+        int getDropped () const { return dropped.get (); }       // blocks
+        //----------------------------------------------------------------------
+        void prepare (double sampleRate, int samplesPerBlock)
+        {
+            Fs = sampleRate;
+            blockSize = samplesPerBlock;
+            prepared = 1;
+        }
+        //----------------------------------------------------------------------
+        // audio thread, wait-free: the input before processing and the
+        // parameters (numParameters values) it is processed with
+        //----------------------------------------------------------------------
+        void block (const float* left, const float* right, int n,
+                    const float* parameters)
+        {
+            if (active.get () == 0) return;
+            ++busy;
+            if (active.get () != 0 && ! record (left, right, n, parameters))
+            {
+                ++gapBlocks; gapSamples += n;
+                ++dropped;
+            }
+            --busy;
+        }
+        //----------------------------------------------------------------------
+    private:
+        //----------------------------------------------------------------------
+        AbstractFifo fifo;
+        HeapBlock<char> ring;
+        ScopedPointer<FileOutputStream> stream;
+        Atomic<int> active, busy, prepared, dropped;
+        Atomic<int64> written;
+        double Fs;
+        int blockSize;
+        //----------------------------------------------------------------------
+        // audio thread only
+        //----------------------------------------------------------------------
+        float last[numParameters];
+        bool sync;                          // every parameter is due
+        int gapBlocks;
+        int64 gapSamples;
+        //----------------------------------------------------------------------
+        // setup records first: a block is only logged once everything it
+        // depends on is, anything that does not fit is retried next block
+        //----------------------------------------------------------------------
+        bool record (const float* left, const float* right, int n,
+                     const float* parameters)
+        {
+            char h[16];
+            if (gapBlocks > 0)
+            {
+                h[0] = gapRecord; put (h + 1, gapBlocks); put (h + 5, gapSamples);
+                if (! push (h, 13)) return false;
+                gapBlocks = 0; gapSamples = 0;
+            }
+            if (prepared.get () != 0)
+            {
+                h[0] = prepareRecord; put (h + 1, Fs); put (h + 9, blockSize);
+                if (! push (h, 13)) return false;
+                prepared = 0;
+            }
+            for (int i = 0; i < numParameters; ++i)
+            {
+                if (! sync && parameters[i] == last[i]) continue;
+                h[0] = parameterRecord; put (h + 1, i); put (h + 5, parameters[i]);
+                if (! push (h, 9)) { sync = true; return false; }
+                last[i] = parameters[i];
+            }
+            sync = false;
+            //------------------------------------------------------------------
+            const int bytes = n * (int) sizeof (float);
+            h[0] = blockRecord; put (h + 1, n);
+            return push (h, 5, left, bytes, right, bytes);
+        }
+        //----------------------------------------------------------------------
+        template <typename V>
+        static inline void put (char* dst, V v) { memcpy (dst, &v, sizeof (V)); }
+        //----------------------------------------------------------------------
+        // all or nothing, the record may wrap around the ring
+        //----------------------------------------------------------------------
+        bool push (const void* a, int na, const void* b = nullptr, int nb = 0,
+                   const void* c = nullptr, int nc = 0)
+        {
+            const int total = na + nb + nc;
+            if (fifo.getFreeSpace () < total) return false;
+            int s1, n1, s2, n2;
+            fifo.prepareToWrite (total, s1, n1, s2, n2);
+            //------------------------------------------------------------------
+            char* dst[2] = { ring + s1, ring + s2 };
+            int room[2] = { n1, n2 };
+            const char* src[3] = { (const char*) a, (const char*) b, (const char*) c };
+            int size[3] = { na, nb, nc };
+            for (int p = 0, k = 0; p < 3; ++p)
+                while (size[p] > 0)
+                {
+                    if (room[k] == 0) ++k;
+                    const int m = jmin (size[p], room[k]);
+                    memcpy (dst[k], src[p], m);
+                    dst[k] += m; room[k] -= m; src[p] += m; size[p] -= m;
+                }
+            fifo.finishedWrite (total);
+            return true;
+        }
+        //----------------------------------------------------------------------
+        void run ()
+        {
+            while (! threadShouldExit ())
+            {
+                drain ();
+                wait (20);
+            }
+            drain ();
+            stream->flush ();
+        }
+        //----------------------------------------------------------------------
+        void drain ()
+        {
+            int s1, n1, s2, n2;
+            fifo.prepareToRead (fifo.getNumReady (), s1, n1, s2, n2);
+            if (n1 > 0) stream->write (ring + s1, n1);
+            if (n2 > 0) stream->write (ring + s2, n2);
+            fifo.finishedRead (n1 + n2);
+            written += n1 + n2;
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Recorder)
+};
+//==============================================================================
+// Reader: one record at a time, the block samples stay valid (and may be
+// processed in place) until the next one
+//==============================================================================
+struct Event
+{
+    int type;
+    double Fs; int blockSize;                           // prepareRecord
+    int index; float value;                             // parameterRecord
+    int numSamples; float* left; float* right;          // blockRecord
+    int gapBlocks; int64 gapSamples;                    // gapRecord
+};
+//------------------------------------------------------------------------------
+class Reader
+{
+    public:
+        Reader (const File& f) : in (f), valid (false), size (0)
+        {
+            valid = in.openedOk () && in.readInt () == magic
+                                   && in.readInt () == version;
+        }
+        //----------------------------------------------------------------------
+        bool isValid () const { return valid; }
+        //----------------------------------------------------------------------
+        // false at the end, or at a record cut short (capture interrupted)
+        //----------------------------------------------------------------------
+        bool next (Event& e)
+        {
+            if (! valid || ! has (1)) return false;
+            zerostruct (e);
+            e.type = (uint8) in.readByte ();
+            switch (e.type)
+            {
+                case prepareRecord:
+                    if (! has (12)) return false;
+                    e.Fs = in.readDouble (); e.blockSize = in.readInt ();
+                    return true;
+                case parameterRecord:
+                    if (! has (8)) return false;
+                    e.index = in.readInt (); e.value = in.readFloat ();
+                    return true;
+                case gapRecord:
+                    if (! has (12)) return false;
+                    e.gapBlocks = in.readInt (); e.gapSamples = in.readInt64 ();
+                    return true;
+                case blockRecord:
+                {
+                    if (! has (4)) return false;
+                    const int n = in.readInt ();
+                    if (n <= 0 || n > maxBlockSize || ! has (2 * n * sizeof (float)))
+                        return false;
+                    if (n > size) { left.malloc (n); right.malloc (n); size = n; }
+                    in.read (left, n * sizeof (float));
+                    in.read (right, n * sizeof (float));
+                    e.numSamples = n; e.left = left; e.right = right;
+                    return true;
+                }
+                default: return false;
+            };
+        }
+        //----------------------------------------------------------------------
+    private:
+        enum { maxBlockSize = Recorder::capacity / (2 * sizeof (float)) };
+        //----------------------------------------------------------------------
+        FileInputStream in;
+        bool valid;
+        HeapBlock<float> left, right;
+        int size;
+        //----------------------------------------------------------------------
+        bool has (int64 bytes) { return in.getTotalLength () - in.getPosition () >= bytes; }
+};
+//==============================================================================
+// Replay
+//==============================================================================
+struct BlockTiming
+{
+    int64 position;     // first sample of the block, in the capture
+    int numSamples;
+    double Fs;
+    double seconds;     // processing time
+    SolverStats solver; // push/pull Newton solves of the block
+};
+//------------------------------------------------------------------------------
+struct Summary
+{
+    int prepares, parameters, gaps;
+    int64 gapSamples;
+};
+//------------------------------------------------------------------------------
+// processes the whole capture in place of the host, one BlockTiming per
+// input block
+//------------------------------------------------------------------------------
+template <typename T>
+static bool replay (const File& f, Array<BlockTiming>& blocks, Summary& summary)
+{
+    Reader reader (f);
+    if (! reader.isValid ()) return false;
+    //--------------------------------------------------------------------------
+    ScopedPointer<StereoProcessor<T>> p (new StereoProcessor<T> ());
+    double Fs = 0.0;
+    int blockSize = 0;
+    int64 position = 0;
+    zerostruct (summary);
+    //--------------------------------------------------------------------------
+    Event e;
+    while (reader.next (e))
+    {
+        switch (e.type)
+        {
+            case prepareRecord: // as Wavechild670Processor::prepareToPlay
+                ++summary.prepares;
+                if (e.Fs != Fs || e.blockSize != blockSize)
+                {
+                    Fs = e.Fs; blockSize = e.blockSize;
+                    p->init (Fs, blockSize, false);
+                    warmStart (*p);
+                }
+                break;
+            case parameterRecord:
+                ++summary.parameters;
+                if (blockSize > 0) applyParameter (*p, e.index, e.value);
+                break;
+            case gapRecord:
+                ++summary.gaps; summary.gapSamples += e.gapSamples;
+                position += e.gapSamples;
+                break;
+            case blockRecord:
+            {
+                if (blockSize <= 0) break;
+                p->takeSolverStats ();
+                //--------------------------------------------------------------
+                const int64 t0 = Time::getHighResolutionTicks ();
+                p->processBlock (e.left, e.right, e.numSamples);
+                const double t = Time::highResolutionTicksToSeconds (
+                                     Time::getHighResolutionTicks () - t0);
+                //--------------------------------------------------------------
+                BlockTiming b;
+                b.position = position; b.numSamples = e.numSamples; b.Fs = Fs;
+                b.seconds = t; b.solver = p->takeSolverStats ();
+                blocks.add (b);
+                position += e.numSamples;
+                break;
+            }
+            default: break;
+        };
+    }
+    return true;
+}
+//==============================================================================
+} // namespace Capture
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_CAPTURE_HPP_3B9E05D1__
+//==============================================================================
\ No newline at end of file
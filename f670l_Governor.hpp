@@ -0,0 +1,186 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_GOVERNOR_HPP_A41D7C92__
+#define __F670L_GOVERNOR_HPP_A41D7C92__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// CPU-budget governor
+//------------------------------------------------------------------------------
+// Measures each block against a budget (fraction of the block duration) and
+// moves the push/pull solver between quality tiers:
+//
+//      - degrade at once when a block overruns the budget, or when the
+//        smoothed load stays above it
+//      - recover one tier after holdBlocks blocks below recover*budget
+//      - refuse a degraded tier as soon as one of its solves stops at the
+//        iteration cap above its tolerance: back one tier, which becomes
+//        the deepest allowed; the refusal decays, every refusalBlocks
+//        blocks without failure allow one tier deeper again (a transient
+//        does not disable degradation for the session)
+//
+// Every tier keeps at least one line-search halving, so a step that
+// overshoots is still damped when the iteration cap is short.
+// Only the Newton tolerance and iteration caps change between tiers: the
+// solution moves by less than the tolerance, so transitions are click-free.
+// The table-vs-iterative trade is the small-signal fast path: each tier
+// widens the tolerance under which the triodes are evaluated from their
+// linearized model instead of iterating (there is no tabulated tube model).
+// The antialiasing order is not governed (changing it shifts the signal by
+// half a sample), and the model has no oversampling to trade.
+//==============================================================================
+struct GovernorTier
+{
+    const char* name;
+    double tolerance;
+    int iterations, halvings;
+    double linear;      // small-signal fast path tolerance
+};
+//------------------------------------------------------------------------------
+static const GovernorTier governorTiers[] =
+{
+    { "full",   1e-9, 20, 8, 1e-6 },
+    { "high",   1e-7,  8, 4, 1e-5 },
+    { "medium", 1e-5,  4, 2, 1e-4 },
+    { "low",    1e-4,  2, 1, 1e-3 }
+};
+//==============================================================================
+template <typename T>
+class Governor
+{
+    public:
+        enum { numTiers = sizeof (governorTiers) / sizeof (governorTiers[0]) };
+        //----------------------------------------------------------------------
+        Governor (StereoProcessor<T>& p, double budgetFraction = 0.5)
+            : processor (p), budget (budgetFraction), recover (0.6),
+              holdBlocks (64), below (0), limit (numTiers - 1),
+              refusalBlocks (1024), clean (0), load (0.0), start (0)
+        {}
+        //----------------------------------------------------------------------
+        // after the processor is (re)initialised
+        //----------------------------------------------------------------------
+        void reset ()
+        {
+            below = 0; load = 0.0; limit = numTiers - 1; clean = 0;
+            processor.takeSolverFailures ();
+            apply (tier.get ());
+        }
+        //----------------------------------------------------------------------
+        void setBudget (double fraction) { budget = jlimit (0.01, 1.0, fraction); }
+        void setHysteresis (double recoverRatio, int blocks)
+        {
+            recover = jlimit (0.1, 1.0, recoverRatio); holdBlocks = jmax (1, blocks);
+        }
+        //----------------------------------------------------------------------
+        // blocks without solver failure before a refused tier is allowed again
+        //----------------------------------------------------------------------
+        void setRefusalDecay (int blocks) { refusalBlocks = jmax (1, blocks); }
+        //----------------------------------------------------------------------
+        // around the processing of one block (audio thread)
+        //----------------------------------------------------------------------
+        inline void begin () { start = Time::getHighResolutionTicks (); }
+        //----------------------------------------------------------------------
+        inline void end (int numSamples)
+        {
+            if (numSamples <= 0) return;
+            const double elapsed = Time::highResolutionTicksToSeconds (
+                                       Time::getHighResolutionTicks () - start);
+            const double instant = elapsed * processor.Fs / numSamples;
+            load = 0.9 * load + 0.1 * instant;
+            //------------------------------------------------------------------
+            const int t = tier.get ();
+            const bool failed = processor.takeSolverFailures () > 0;
+            if (failed) clean = 0;
+            else if (limit < numTiers - 1 && ++clean >= refusalBlocks)
+            {
+                ++limit; clean = 0;                     // refusal decays
+            }
+            //------------------------------------------------------------------
+            if (failed && t > 0)
+            {
+                limit = t - 1; apply (t - 1); below = 0; // refused tier
+            }
+            else if ((instant > budget || load > budget) && t < limit)
+            {
+                apply (t + 1); below = 0;
+            }
+            else if (load < recover * budget && t > 0)
+            {
+                if (++below >= holdBlocks) { apply (t - 1); below = 0; }
+            }
+            else below = 0;
+            loadPercent = roundToInt (load * 100.0);
+        }
+        //----------------------------------------------------------------------
+        inline void processBlock (float* left, float* right, int numSamples)
+        {
+            begin ();
+            processor.processBlock (left, right, numSamples);
+            end (numSamples);
+        }
+        //----------------------------------------------------------------------
+        // reporting (any thread)
+        //----------------------------------------------------------------------
+        int getTier () const { return tier.get (); }
+        const char* getTierName () const { return governorTiers[tier.get ()].name; }
+        int getLoadPercent () const { return loadPercent.get (); }
+        //----------------------------------------------------------------------
+    private:
+        void apply (int t)
+        {
+            const GovernorTier& g = governorTiers[t];
+            processor.setSolverQuality ((T) g.tolerance, g.iterations, g.halvings);
+            processor.setLinearTolerance ((T) g.linear);
+            tier = t;
+        }
+        //----------------------------------------------------------------------
+        StereoProcessor<T>& processor;
+        double budget, recover;
+        int holdBlocks, below;
+        int limit;              // deepest tier allowed (refusals)
+        int refusalBlocks;      // clean blocks per tier of refusal decay
+        int clean;              // blocks since the last solver failure
+        double load;            // smoothed, fraction of real time
+        int64 start;
+        Atomic<int> tier, loadPercent;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Governor)
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_GOVERNOR_HPP_A41D7C92__
+//==============================================================================
\ No newline at end of file
@@ -80,8 +80,45 @@ class LevelTimeConstant
         //----------------------------------------------------------------------
         T process (T Iin) // Iin == current (current law apply)
         {
-            root.incident (root.reflected() - (2.0*(Iin * root.R())));
-            return C1.voltage();
+            program.incident (program.reflected() - (2.0*(Iin * program.R())));
+            return program.voltage (iC1);
+        }
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
+        {
+            WDF::Capacitor<T>* C[3] = { &C1, &C2, &C3 };
+            for (int i = 0; i < 3; ++i)
+            {
+                const int n = program.indexOf (C[i]);
+                T v = program.getValue (n); s.io (v); program.setValue (n, v);
+            }
+        }
+        //----------------------------------------------------------------------
+        // running states of another network (same wiring)
+        //----------------------------------------------------------------------
+        void copyState (const LevelTimeConstant& other)
+        {
+            const WDF::Capacitor<T>* C[3] = { &C1, &C2, &C3 };
+            const WDF::Capacitor<T>* D[3] = { &other.C1, &other.C2, &other.C3 };
+            for (int i = 0; i < 3; ++i)
+                program.setValue (program.indexOf (C[i]),
+                                  other.program.getValue (other.program.indexOf (D[i])));
+        }
+        //----------------------------------------------------------------------
+        // running states moved to the mean of this and another network (same
+        // wiring: its output becomes the mean of both outputs)
+        //----------------------------------------------------------------------
+        void averageState (const LevelTimeConstant& other)
+        {
+            const WDF::Capacitor<T>* C[3] = { &C1, &C2, &C3 };
+            const WDF::Capacitor<T>* D[3] = { &other.C1, &other.C2, &other.C3 };
+            for (int i = 0; i < 3; ++i)
+            {
+                const int n = program.indexOf (C[i]);
+                program.setValue (n, 0.5 * (program.getValue (n)
+                    + other.program.getValue (other.program.indexOf (D[i]))));
+            }
         }
         //----------------------------------------------------------------------
     protected:
@@ -94,6 +131,9 @@ class LevelTimeConstant
         WDF::Parallel<T>    paral_B;
         WDF::Parallel<T>    root;
         //----------------------------------------------------------------------
+        WDF::Program<T>     program; // flattened tree, see wiring(), update()
+        int                 iC1;
+        //----------------------------------------------------------------------
         /**
                 --------------------------
                 |       |    |     |     |
@@ -111,12 +151,15 @@ class LevelTimeConstant
             serie_B.connect (&R3,       &C3);
             paral_B.connect (&serie_A,  &serie_B);
                root.connect (&paral_A,  &paral_B);
+            //------------------------------------------------------------------
+            program.compile (&root);
+            iC1 = program.indexOf (&C1);
         }
         //----------------------------------------------------------------------
         void update (T Fs, T CT = 2e-6,  T CU = 8e-6, T CV = 20e-6,
                            T RT = 220e3, T RU = 1e9,  T RV = 1e9)
         {
-            T hFs = FS*.5;
+            T hFs = Fs*.5;
             //------------------------------------------------------------------
             C1.Rp = hFs*CT;
             C2.Rp = hFs*CU;
@@ -126,7 +169,11 @@ class LevelTimeConstant
             R2.Rp = RU;
             R3.Rp = RV;
             //------------------------------------------------------------------
-            wiring ();
+            // same tree: coefficients updated in place (a switch may come
+            // from another thread while process() runs, the capacitor
+            // states stay in the program)
+            //------------------------------------------------------------------
+            program.refresh ();
         }
         //----------------------------------------------------------------------
 };
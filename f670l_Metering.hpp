@@ -0,0 +1,192 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_METERING_HPP_3C7E25D0__
+#define __F670L_METERING_HPP_3C7E25D0__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_SignalAmplifier.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Metering channel (audio thread -> editor)
+//------------------------------------------------------------------------------
+// The audio thread folds each block into accumulators (peak, sum of
+// squares, level cap voltages, Newton statistics) and publishes them in a
+// seqlock snapshot: two atomic increments and a copy, never a lock or a
+// message. The reader (editor timer) retries while a publish is in flight
+// and marks the frame consumed, which restarts the accumulation, so peaks
+// between two display refreshes are never lost and the reader decimates at
+// its own rate.
+//==============================================================================
+struct MeterLevels
+{
+    MeterLevels () { clear (); }
+    void clear () { peak[0] = peak[1] = 0.0f; sum[0] = sum[1] = 0.0; count = 0; }
+    //--------------------------------------------------------------------------
+    template <typename T>
+    inline void measure (const T* a, const T* b, int n, T gain = 1.0)
+    {
+        T pa = 0.0, pb = 0.0, sa = 0.0, sb = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            pa = jmax (pa, (T) fabs (a[i])); sa += a[i]*a[i];
+            pb = jmax (pb, (T) fabs (b[i])); sb += b[i]*b[i];
+        }
+        const T g = fabs (gain);
+        peak[0] = jmax (peak[0], (float) (pa * g)); sum[0] += sa * g*g;
+        peak[1] = jmax (peak[1], (float) (pb * g)); sum[1] += sb * g*g;
+        count += n;
+    }
+    //--------------------------------------------------------------------------
+    inline void merge (const MeterLevels& o)
+    {
+        for (int c = 0; c < 2; ++c) { peak[c] = jmax (peak[c], o.peak[c]);
+                                      sum[c] += o.sum[c]; }
+        count += o.count;
+    }
+    //--------------------------------------------------------------------------
+    inline float rms (int c) const { return (count > 0) ? (float) sqrt (sum[c] / count) : 0.0f; }
+    //--------------------------------------------------------------------------
+    float peak[2];
+    double sum[2];
+    int64 count;
+};
+//==============================================================================
+// What the reader gets: channels A/B (left/right, or mid/side when the
+// matrix is on), input after the level controls, output after the gain
+// (before the output clip)
+//==============================================================================
+struct MeterFrame
+{
+    float peakIn[2], rmsIn[2], peakOut[2], rmsOut[2];
+    float cap[2], capMax[2];        // level cap voltage: last, max (volts)
+    float iterations;               // mean Newton iterations per solve
+    int worstIterations;
+    uint32 blocks;                  // blocks folded in this frame
+};
+//==============================================================================
+class Meter
+{
+    public:
+        Meter () : sequence (0), acknowledged (0), lastRead (0), blocks (0)
+        {
+            zeromem (&shared, sizeof (shared));
+            capMax[0] = capMax[1] = 0.0f;
+        }
+        //----------------------------------------------------------------------
+        // audio thread (single writer), wait-free: input() and output() for
+        // the block, then publish()
+        //----------------------------------------------------------------------
+        template <typename T>
+        inline void input (const T* a, const T* b, int n) { blockIn.measure (a, b, n); }
+        inline void input (const MeterLevels& levels) { blockIn.merge (levels); }
+        //----------------------------------------------------------------------
+        template <typename T>
+        inline void output (const T* a, const T* b, int n, T gain)
+        {
+            blockOut.measure (a, b, n, gain);
+        }
+        //----------------------------------------------------------------------
+        template <typename T>
+        void publish (T capA, T capB, const SolverStats& solver)
+        {
+            //------------------------------------------------------------------
+            // the reader acknowledged the last frame: start a new one
+            //------------------------------------------------------------------
+            if (acknowledged.get () == sequence.get ())
+            {
+                in.clear (); out.clear (); stats.reset ();
+                capMax[0] = capMax[1] = 0.0f; blocks = 0;
+            }
+            in.merge (blockIn);   blockIn.clear ();
+            out.merge (blockOut); blockOut.clear ();
+            capMax[0] = jmax (capMax[0], (float) capA);
+            capMax[1] = jmax (capMax[1], (float) capB);
+            stats.add (solver);
+            ++blocks;
+            //------------------------------------------------------------------
+            sequence += 1;                      // odd: write in progress
+            shared.cap[0] = (float) capA; shared.cap[1] = (float) capB;
+            for (int c = 0; c < 2; ++c)
+            {
+                shared.peakIn[c]  = in.peak[c];  shared.rmsIn[c]  = in.rms (c);
+                shared.peakOut[c] = out.peak[c]; shared.rmsOut[c] = out.rms (c);
+                shared.capMax[c] = capMax[c];
+            }
+            shared.iterations = (stats.solves > 0)
+                              ? (float) stats.iterations / stats.solves : 0.0f;
+            shared.worstIterations = stats.worst;
+            shared.blocks = blocks;
+            sequence += 1;                      // even: stable
+        }
+        //----------------------------------------------------------------------
+        // reader (a single non audio thread): true when a new stable frame
+        // was copied. A frame published after the copy is not reset, its
+        // data carries over to the next read.
+        //----------------------------------------------------------------------
+        bool read (MeterFrame& frame, int tries = 4)
+        {
+            for (int k = 0; k < tries; ++k)
+            {
+                const uint32 s0 = sequence.get ();
+                if (s0 & 1) continue;
+                memcpy (&frame, (const void*) &shared, sizeof (frame));
+                Atomic<int>::memoryBarrier ();
+                if (sequence.get () != s0) continue;
+                //--------------------------------------------------------------
+                acknowledged = s0;
+                const bool fresh = (s0 != lastRead);
+                lastRead = s0;
+                return fresh;
+            }
+            return false;
+        }
+        //----------------------------------------------------------------------
+    private:
+        Atomic<uint32> sequence, acknowledged;
+        uint32 lastRead;                // reader only
+        MeterFrame shared;
+        //----------------------------------------------------------------------
+        MeterLevels blockIn, blockOut;  // audio thread only
+        MeterLevels in, out;
+        float capMax[2];
+        SolverStats stats;
+        uint32 blocks;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Meter)
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_METERING_HPP_3C7E25D0__
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,422 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+#ifndef __F670L_MULTICHANNEL_PROCESSOR_HPP_955FB178__
+#define __F670L_MULTICHANNEL_PROCESSOR_HPP_955FB178__
+//==============================================================================
+#include "f670l_SignalAmplifier.hpp"
+#include "f670l_LevelTimeConstant.hpp"
+#include "f670l_SidechainAmplifier.hpp"
+#include "f670l_Profiling.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Channel layouts and link groups
+//------------------------------------------------------------------------------
+// A link group is a set of channels sharing one level time constant
+// network: the sidechain currents of its members are averaged into that
+// network and all of them are driven by the same level cap voltage (the
+// linked stereo pair is the two channel case). groups[c] is the group of
+// channel c, groups are numbered from 0 without holes.
+//==============================================================================
+struct ChannelLayout
+{
+    enum { maxChannels = 24 };
+    //--------------------------------------------------------------------------
+    ChannelLayout (int channels = 2, bool linked = true)
+        : numChannels (jlimit (1, (int) maxChannels, channels))
+    {
+        for (int c = 0; c < maxChannels; ++c) groups[c] = linked ? 0 : c;
+    }
+    //--------------------------------------------------------------------------
+    // puts channels [first, first + count) in group g (a range outside the
+    // channels or a group outside [0, maxChannels) is rejected)
+    //--------------------------------------------------------------------------
+    ChannelLayout& link (int first, int count, int g)
+    {
+        if (first < 0 || count < 0 || first + count > numChannels
+            || g < 0 || g >= maxChannels)
+        {
+            jassertfalse; return *this;
+        }
+        for (int c = first; c < first + count; ++c)
+            groups[c] = g;
+        return *this;
+    }
+    //--------------------------------------------------------------------------
+    int numGroups () const
+    {
+        int n = 0;
+        for (int c = 0; c < numChannels; ++c) n = jmax (n, groups[c] + 1);
+        return n;
+    }
+    //--------------------------------------------------------------------------
+    static ChannelLayout mono () { return ChannelLayout (1); }
+    static ChannelLayout stereo (bool linked = true)
+    {
+        return ChannelLayout (2, linked);
+    }
+    //--------------------------------------------------------------------------
+    // L R C LFE Ls Rs: front (L R C), LFE alone, surround pair
+    //--------------------------------------------------------------------------
+    static ChannelLayout surround51 ()
+    {
+        return ChannelLayout (6).link (0, 3, 0).link (3, 1, 1).link (4, 2, 2);
+    }
+    //--------------------------------------------------------------------------
+    // L R C LFE Ls Rs Lrs Rrs Ltf Rtf Ltr Rtr: front (L R C), LFE alone,
+    // surrounds (side and rear), heights
+    //--------------------------------------------------------------------------
+    static ChannelLayout immersive714 ()
+    {
+        return ChannelLayout (12).link (0, 3, 0).link (3, 1, 1)
+                                 .link (4, 4, 2).link (8, 4, 3);
+    }
+    //--------------------------------------------------------------------------
+    int numChannels;
+    int groups[maxChannels];
+};
+//==============================================================================
+// N channel limiter core
+//------------------------------------------------------------------------------
+// Same circuit as StereoProcessor (no mid/side matrix, which only means
+// something for a pair) for any channel count. Each channel keeps its own
+// circuit objects: the push/pull Newton solves take a data-dependent number
+// of iterations per channel, so they are not run as SIMD lanes. Sample
+// blocks are channel-major (gate[c*blockSize + i]) so the linear stages and
+// the feed-forward tubes run over contiguous memory; the sidechain (and the
+// tubes in feedback mode) walk all the channels of one frame before the
+// next. Each link group runs a single time constant network whatever its
+// size, and a mono layout owns exactly one of everything.
+//==============================================================================
+template <typename T>
+class MultichannelProcessor
+{
+    public:
+        MultichannelProcessor ()
+            : Fs (44100.0), gain (1.0),
+              blockSize (0), numChannels (0), numGroups (0),
+              //-------------------------
+              hardclipout (true),
+                 feedback (false),
+              antialiasing (0),
+              clipAntialiasing (0),
+              diodeBridge (false),
+              profiler (nullptr)
+        {}
+        //----------------------------------------------------------------------
+        void init (const ChannelLayout& channelLayout, T sampleRate,
+                   int maxBlockSize = 512, bool warm = true)
+        {
+            Fs = sampleRate;
+            layout = channelLayout;
+            numChannels = layout.numChannels;
+            numGroups = layout.numGroups ();
+            //------------------------------------------------------------------
+            blockSize = jmax (1, maxBlockSize);
+            gate.allocate (numChannels * blockSize, true);
+            capBuf.allocate (numChannels * blockSize, true);
+            //------------------------------------------------------------------
+            level.allocate (numChannels, false);
+            cap.allocate (numChannels, true);
+            frame.allocate (numChannels, true);
+            group.allocate (numChannels, false);
+            //------------------------------------------------------------------
+            Isc.allocate (numGroups, true);
+            groupCap.allocate (numGroups, true);
+            groupScale.allocate (numGroups, true);
+            tc.allocate (numGroups, false);
+            //------------------------------------------------------------------
+            signalAmps.clear ();
+            sidechainAmps.clear ();
+            timeConstants.clear ();
+            clips.clear ();
+            //------------------------------------------------------------------
+            int c = 0;
+            for (; c < numChannels; ++c)
+            {
+                level[c] = 1.0;
+                group[c] = layout.groups[c];
+                groupScale[group[c]] += 1.0;
+                signalAmps.add (new SignalAmplifier<T> (Fs));
+                sidechainAmps.add (new SidechainAmplifier<T> (Fs));
+                clips.add (new WDF::ADAA<T, WDF::HardClip<T>> (WDF::HardClip<T> (-1.0, 1.0), 0));
+            }
+            //------------------------------------------------------------------
+            int g = 0;
+            for (; g < numGroups; ++g)
+            {
+                groupScale[g] = (groupScale[g] > 0.0) ? 1.0 / groupScale[g] : 0.0;
+                tc[g] = 2;
+                timeConstants.add (new LevelTimeConstant<T> (Fs));
+                timeConstants[g]->parameters (Fs, tc[g]);
+            }
+            //------------------------------------------------------------------
+            setAntialiasing (antialiasing);
+            setClipAntialiasing (clipAntialiasing);
+            setDiodeBridge (diodeBridge);
+            //------------------------------------------------------------------
+            if (warm) warmup ();
+        }
+        //----------------------------------------------------------------------
+        int getNumChannels () const { return numChannels; }
+        int getNumGroups () const { return numGroups; }
+        const ChannelLayout& getLayout () const { return layout; }
+        //----------------------------------------------------------------------
+        // time constant switch of a link group, input level of a channel
+        //----------------------------------------------------------------------
+        void parameters (int g, const int index)
+        {
+            if (g < 0 || g >= numGroups) return;
+            tc[g] = index; timeConstants[g]->parameters (Fs, tc[g]);
+        }
+        //----------------------------------------------------------------------
+        void setLevel (int c, T value)
+        {
+            if (c >= 0 && c < numChannels) level[c] = value;
+        }
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
+        {
+            int c = 0, g = 0;
+            for (; c < numChannels; ++c) s.io (cap[c]);
+            for (c = 0; c < numChannels; ++c) signalAmps[c]->state (s);
+            for (c = 0; c < numChannels; ++c) sidechainAmps[c]->state (s);
+            for (; g < numGroups; ++g) timeConstants[g]->state (s);
+            for (c = 0; c < numChannels; ++c) clips[c]->state (s);
+        }
+        //----------------------------------------------------------------------
+        void setSolverQuality (T tolerance, int iterations, int halvings)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                signalAmps[c]->setSolverQuality (tolerance, iterations, halvings);
+        }
+        //----------------------------------------------------------------------
+        void setLinearTolerance (T tolerance)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                signalAmps[c]->setLinearTolerance (tolerance);
+        }
+        //----------------------------------------------------------------------
+        void setQuietTolerance (T amps)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                sidechainAmps[c]->setQuietTolerance (amps);
+        }
+        //----------------------------------------------------------------------
+        void setPredictor (int predictor)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                signalAmps[c]->setPredictor (predictor);
+        }
+        //----------------------------------------------------------------------
+        // sidechain and output clip antialiasing orders (0 = off, default,
+        // see StereoProcessor)
+        //----------------------------------------------------------------------
+        void setAntialiasing (int order)
+        {
+            antialiasing = jlimit (0, 2, order);
+            for (int c = 0; c < numChannels; ++c)
+                sidechainAmps[c]->setAntialiasing (antialiasing);
+        }
+        //----------------------------------------------------------------------
+        void setClipAntialiasing (int order)
+        {
+            clipAntialiasing = jlimit (0, 2, order);
+            for (int c = 0; c < numChannels; ++c)
+                clips[c]->setOrder (clipAntialiasing);
+        }
+        //----------------------------------------------------------------------
+        void setDiodeBridge (bool diodes)
+        {
+            diodeBridge = diodes;
+            for (int c = 0; c < numChannels; ++c)
+                sidechainAmps[c]->setDiodeBridge (diodeBridge);
+        }
+        //----------------------------------------------------------------------
+        void setProfiler (Profiling::Profiler* p) { profiler = p; }
+        //----------------------------------------------------------------------
+        // one frame of sidechain voltages (one per channel) to the level caps
+        //----------------------------------------------------------------------
+        inline void sidechain (const T* Vsc)
+        {
+            int c = 0, g = 0;
+            for (; g < numGroups; ++g) Isc[g] = 0.0;
+            for (; c < numChannels; ++c)
+                Isc[group[c]] += sidechainAmps[c]->process (Vsc[c], cap[c]);
+            for (g = 0; g < numGroups; ++g)
+                groupCap[g] = timeConstants[g]->process (Isc[g] * groupScale[g]);
+            for (c = 0; c < numChannels; ++c)
+                cap[c] = groupCap[group[c]];
+        }
+        //----------------------------------------------------------------------
+        // planar float channels, in place (numChannels pointers)
+        //----------------------------------------------------------------------
+        void processBlock (float* const* channels, int numSamples)
+        {
+            WAVECHILD670_PROFILE_BLOCK (profiler, numSamples);
+            int offset = 0;
+            while (offset < numSamples)
+            {
+                const int n = jmin (numSamples - offset, blockSize);
+                readInput (channels, offset, n);
+                processFront (!feedback, n);
+                processBack (!feedback, n);
+                writeOutput (channels, offset, n);
+                offset += n;
+            }
+        }
+        //----------------------------------------------------------------------
+        inline void readInput (const float* const* channels, int offset, int n)
+        {
+            WAVECHILD670_PROFILE_STAGE (profiler, inputStage);
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const float* in = channels[c] + offset;
+                T* g = gate + c * blockSize;
+                const T l = level[c];
+                for (int i = 0; i < n; ++i) g[i] = (T) in[i] * l;
+            }
+        }
+        //----------------------------------------------------------------------
+        inline void writeOutput (float* const* channels, int offset, int n)
+        {
+            WAVECHILD670_PROFILE_STAGE (profiler, outputStage);
+            for (int c = 0; c < numChannels; ++c)
+            {
+                float* out = channels[c] + offset;
+                const T* g = gate + c * blockSize;
+                WDF::ADAA<T, WDF::HardClip<T>>& clip = *clips[c];
+                int i = 0;
+                if (hardclipout) for (; i < n; ++i) out[i] = (float) clip.process (g[i] * gain);
+                else             for (; i < n; ++i) out[i] = (float) (g[i] * gain);
+            }
+        }
+        //----------------------------------------------------------------------
+        // Front stage: feed-forward sidechain (frame by frame) then the input
+        // transformers over each contiguous channel block
+        //----------------------------------------------------------------------
+        void processFront (bool feedforward, int n)
+        {
+            int c, i = 0;
+            if (feedforward)
+            {
+                WAVECHILD670_PROFILE_STAGE (profiler, sidechainStage);
+                for (; i < n; ++i)
+                {
+                    for (c = 0; c < numChannels; ++c) frame[c] = gate[c * blockSize + i];
+                    sidechain (frame);
+                    for (c = 0; c < numChannels; ++c) capBuf[c * blockSize + i] = cap[c];
+                }
+            }
+            //------------------------------------------------------------------
+            WAVECHILD670_PROFILE_STAGE (profiler, transformerStage);
+            for (c = 0; c < numChannels; ++c)
+            {
+                T* g = gate + c * blockSize;
+                signalAmps[c]->transformBlock (g, g, n);
+            }
+        }
+        //----------------------------------------------------------------------
+        // Back stage: push/pull tube pairs and feedback sidechain, in place
+        //----------------------------------------------------------------------
+        void processBack (bool feedforward, int n)
+        {
+            int c, i = 0;
+            if (feedforward)
+            {
+                WAVECHILD670_PROFILE_STAGE (profiler, tubeStage);
+                for (c = 0; c < numChannels; ++c)
+                {
+                    T* g = gate + c * blockSize;
+                    const T* k = capBuf + c * blockSize;
+                    SignalAmplifier<T>& amp = *signalAmps[c];
+                    for (i = 0; i < n; ++i) g[i] = amp.processTubes (g[i], k[i]);
+                }
+                return;
+            }
+            //------------------------------------------------------------------
+            // feedback: the sidechain runs on each output frame
+            //------------------------------------------------------------------
+            WAVECHILD670_PROFILE_STAGE (profiler, feedbackStage);
+            for (; i < n; ++i)
+            {
+                for (c = 0; c < numChannels; ++c)
+                {
+                    const int k = c * blockSize + i;
+                    frame[c] = signalAmps[c]->processTubes (gate[k], cap[c]);
+                    gate[k] = frame[c];
+                }
+
+                sidechain (frame);
+            }
+        }
+        //----------------------------------------------------------------------
+        void warmup (T timeInSec = 0.5)
+        {
+            long i, samples = (long) (timeInSec*Fs)/2;
+            int c;
+            i = 0; for (; i < samples; ++i)
+                for (c = 0; c < numChannels; ++c) signalAmps[c]->process (0.0, cap[c]);
+            i = 0; for (; i < samples; ++i)
+            {
+                for (c = 0; c < numChannels; ++c) frame[c] = signalAmps[c]->process (0.0, cap[c]);
+                sidechain (frame);
+            }
+        }
+        //----------------------------------------------------------------------
+        T Fs; // samplerate
+        T gain;
+        int blockSize; // block mode chunk size
+        int numChannels, numGroups;
+        ChannelLayout layout;
+        //----------------------------------------------------------------------
+        bool hardclipout, feedback;
+        int antialiasing, clipAntialiasing;
+        bool diodeBridge;
+        Profiling::Profiler* profiler;
+        //----------------------------------------------------------------------
+        HeapBlock<T> level, cap, frame;         // per channel
+        HeapBlock<int> group, tc;               // channel -> group, per group
+        HeapBlock<T> Isc, groupCap, groupScale; // per group
+        HeapBlock<T> gate, capBuf;              // channel-major block scratch
+        //----------------------------------------------------------------------
+        OwnedArray<SignalAmplifier<T>>    signalAmps;
+        OwnedArray<SidechainAmplifier<T>> sidechainAmps;
+        OwnedArray<LevelTimeConstant<T>>  timeConstants; // one per link group
+        OwnedArray<WDF::ADAA<T, WDF::HardClip<T>>> clips; // output clip
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_MULTICHANNEL_PROCESSOR_HPP_955FB178__
+//==============================================================================
\ No newline at end of file
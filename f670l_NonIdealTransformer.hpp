@@ -100,8 +100,32 @@ class NonIdealTransformer : public WDF::TwoPort<T>
         //----------------------------------------------------------------------
         virtual T R () { return root.R (); }
         //----------------------------------------------------------------------
+        virtual int compile (WDF::Program<T>& p) { return root.compile (p); }
+        //----------------------------------------------------------------------
         inline T Vout () { return Cw.voltage(); }
         //----------------------------------------------------------------------
+        // Reactive states (Lp, Lm, Ls, Cw)
+        //----------------------------------------------------------------------
+        enum { numStates = 4 };
+        //----------------------------------------------------------------------
+        inline void getStates (T* s) const
+        {
+            s[0] = Lp.getState(); s[1] = Lm.getState();
+            s[2] = Ls.getState(); s[3] = Cw.getState();
+        }
+        //----------------------------------------------------------------------
+        inline void setStates (const T* s)
+        {
+            Lp.setState (s[0]); Lm.setState (s[1]);
+            Ls.setState (s[2]); Cw.setState (s[3]);
+        }
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
+        {
+            T x[numStates]; getStates (x); s.io (x, numStates); setStates (x);
+        }
+        //----------------------------------------------------------------------
     protected:
         //----------------------------------------------------------------------
         WDF::IdealTransformer<T>    transfo;
@@ -159,7 +183,81 @@ class InputCoupledTransformer : public WDF::OnePort<T>
             serie.incident (b);
         }
         //----------------------------------------------------------------------
+        inline T process (T Vs)
+        {
+            Vin.Vs = Vs;
+            a = serie.reflected ();
+            b = -a; // short circuit rules
+            serie.incident (b);
+            return transformer.Vout();
+        }
+        //----------------------------------------------------------------------
+        template <class Archive> void state (Archive& s) { transformer.state (s); }
+        //----------------------------------------------------------------------
+        // Block mode
+        //----------------------------------------------------------------------
+        // The input transformer is linear and nothing is fed back from the
+        // tubes, so one sample step is an exact state-space recurrence:
+        //
+        //      Vout[n] = C.s[n-1] + D.Vin[n]
+        //      s[n]    = A.s[n-1] + B.Vin[n]
+        //
+        // with s = (Lp, Lm, Ls, Cw). The matrices are probed from the WDF
+        // tree itself (unit state / unit input responses), so they follow any
+        // change of components. Call prepareBlock() after wiring.
+        //----------------------------------------------------------------------
+        void prepareBlock ()
+        {
+            T saved[N], s[N];
+            transformer.getStates (saved);
+            //------------------------------------------------------------------
+            for (int j = 0; j < N; ++j) s[j] = 0.0;
+            transformer.setStates (s);
+            ssD = process (1.0);
+            transformer.getStates (ssB);
+            //------------------------------------------------------------------
+            for (int i = 0; i < N; ++i)
+            {
+                for (int j = 0; j < N; ++j) s[j] = (i == j) ? 1.0 : 0.0;
+                transformer.setStates (s);
+                ssC[i] = process (0.0);
+                transformer.getStates (s);
+                for (int j = 0; j < N; ++j) ssA[j][i] = s[j];
+            }
+            //------------------------------------------------------------------
+            transformer.setStates (saved);
+        }
+        //----------------------------------------------------------------------
+        inline void processBlock (const T* in, T* out, int numSamples)
+        {
+            T s[N], t[N];
+            transformer.getStates (s);
+            //------------------------------------------------------------------
+            for (int n = 0; n < numSamples; ++n)
+            {
+                const T u = in[n];
+                //--------------------------------------------------------------
+                T y = ssD * u;
+                for (int i = 0; i < N; ++i) y += ssC[i] * s[i];
+                out[n] = y;
+                //--------------------------------------------------------------
+                for (int j = 0; j < N; ++j)
+                {
+                    t[j] = ssB[j] * u;
+                    for (int i = 0; i < N; ++i) t[j] += ssA[j][i] * s[i];
+                }
+                for (int j = 0; j < N; ++j) s[j] = t[j];
+            }
+            //------------------------------------------------------------------
+            transformer.setStates (s); // keep the per-sample path in sync
+            if (numSamples > 0) Vin.Vs = in[numSamples - 1];
+        }
+        //----------------------------------------------------------------------
     protected:
+        enum { N = NonIdealTransformer<T>::numStates };
+        //----------------------------------------------------------------------
+        T ssA[N][N], ssB[N], ssC[N], ssD; // block mode state-space
+        //----------------------------------------------------------------------
         WDF::VoltageSource<T>       Vin;
         WDF::Resistor<T>            Rload;
         WDF::Resistor<T>            Rterm;
@@ -0,0 +1,435 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_PIPELINED_PROCESSOR_HPP_469B43AE__
+#define __F670L_PIPELINED_PROCESSOR_HPP_469B43AE__
+//==============================================================================
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_RealtimeSafety.hpp"
+//------------------------------------------------------------------------------
+#if JUCE_MAC || JUCE_IOS
+#include <dispatch/dispatch.h>
+#elif ! JUCE_WINDOWS
+#include <semaphore.h>
+#endif
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Counting semaphore whose post() takes no lock on the caller (a JUCE
+// WaitableEvent locks a mutex to signal on POSIX): sem_t, a dispatch
+// semaphore on macOS, on Windows a count over an auto-reset event (SetEvent
+// takes no user-side lock)
+//==============================================================================
+class Semaphore
+{
+    public:
+#if JUCE_MAC || JUCE_IOS
+        Semaphore () : s (dispatch_semaphore_create (0)) {}
+        ~Semaphore () { dispatch_release (s); }
+        //----------------------------------------------------------------------
+        void post () { dispatch_semaphore_signal (s); }
+        void wait () { dispatch_semaphore_wait (s, DISPATCH_TIME_FOREVER); }
+        void reset () { while (dispatch_semaphore_wait (s, DISPATCH_TIME_NOW) == 0) {} }
+        //----------------------------------------------------------------------
+    private:
+        dispatch_semaphore_t s;
+#elif JUCE_WINDOWS
+        Semaphore () : event (false) {}
+        //----------------------------------------------------------------------
+        void post () { ++count; event.signal (); }
+        void wait ()
+        {
+            for (;;)
+            {
+                const int c = count.get ();
+                if (c > 0) { if (count.compareAndSetBool (c - 1, c)) return; }
+                else event.wait ();
+            }
+        }
+        void reset () { count = 0; event.reset (); }
+        //----------------------------------------------------------------------
+    private:
+        Atomic<int> count;
+        WaitableEvent event;
+#else
+        Semaphore () { sem_init (&s, 0, 0); }
+        ~Semaphore () { sem_destroy (&s); }
+        //----------------------------------------------------------------------
+        void post () { sem_post (&s); }
+        void wait () { while (sem_wait (&s) != 0) {} } // EINTR
+        void reset () { while (sem_trywait (&s) == 0) {} }
+        //----------------------------------------------------------------------
+    private:
+        sem_t s;
+#endif
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Semaphore)
+};
+//==============================================================================
+// Lock-free single producer / single consumer queue of block slot indexes
+//==============================================================================
+template <int capacity>
+class BlockQueue
+{
+    public:
+        BlockQueue () : fifo (capacity + 1) {}
+        //----------------------------------------------------------------------
+        void reset () { fifo.reset (); }
+        //----------------------------------------------------------------------
+        bool push (int index)
+        {
+            int s1, n1, s2, n2;
+            fifo.prepareToWrite (1, s1, n1, s2, n2);
+            if (n1 + n2 == 0) return false;
+            slots[(n1 > 0) ? s1 : s2] = index;
+            fifo.finishedWrite (1);
+            return true;
+        }
+        //----------------------------------------------------------------------
+        bool pop (int& index)
+        {
+            int s1, n1, s2, n2;
+            fifo.prepareToRead (1, s1, n1, s2, n2);
+            if (n1 + n2 == 0) return false;
+            index = slots[(n1 > 0) ? s1 : s2];
+            fifo.finishedRead (1);
+            return true;
+        }
+        //----------------------------------------------------------------------
+    private:
+        AbstractFifo fifo;
+        int slots[capacity + 1];
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// Plugin parameters set from any thread, applied by the audio thread at a
+// block boundary (see applyParameter). The last value per parameter wins.
+//==============================================================================
+class StagedParameters
+{
+    public:
+        StagedParameters () { for (int i = 0; i < numParameters; ++i) dirty[i] = 0; }
+        //----------------------------------------------------------------------
+        // any thread
+        //----------------------------------------------------------------------
+        void set (int index, float value)
+        {
+            if (! isPositiveAndBelow (index, (int) numParameters)) return;
+            values[index] = value;
+            dirty[index] = 1;
+        }
+        //----------------------------------------------------------------------
+        // audio thread (the flag is cleared before the value is read: a value
+        // set meanwhile is applied again at the next boundary)
+        //----------------------------------------------------------------------
+        template <typename T>
+        void apply (StereoProcessor<T>& p)
+        {
+            for (int i = 0; i < numParameters; ++i)
+                if (dirty[i].compareAndSetBool (0, 1))
+                    applyParameter (p, i, values[i].get ());
+        }
+        //----------------------------------------------------------------------
+    private:
+        Atomic<float> values[numParameters];
+        Atomic<int> dirty[numParameters];
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (StagedParameters)
+};
+//==============================================================================
+// Two-stage pipelined execution of a StereoProcessor
+//------------------------------------------------------------------------------
+// The front stage (input matrix, input transformers and, in feed-forward
+// mode, the whole sidechain) runs on a worker thread for block k while the
+// caller runs the back stage (push/pull tubes, output, clip) of block k-1.
+// The two stages touch disjoint parts of the circuit, except the sidechain
+// when the topology is switched: that block is then run serially.
+//
+// Host blocks of any size up to maxBlockSize are accepted, the reported
+// latency is constant and equal to maxBlockSize samples.
+//
+// Blocks move between the stages through lock-free SPSC queues of slot
+// indexes (audio -> worker: front, worker -> audio: back), each push is
+// followed by a semaphore post, nobody polls. Each slot carries an atomic
+// stage: when the worker has not claimed the previous block by the time the
+// next one arrives, the audio thread claims it (compare-and-set) and runs
+// its front stage itself; the worker skips it when it pops the stale index.
+// A front stage the worker claimed is waited for on the semaphore.
+//
+// Parameters go through setParameter(): they are applied at the next block
+// boundary, after the front stage in flight is collected and before the
+// next one is queued, so the worker never sees them change. Governor tier
+// changes (solver tolerance and iteration caps, see Governor) are not
+// staged: a front stage may start under one tier and end under the next,
+// which is the same click-free transition.
+//==============================================================================
+template <typename T>
+class PipelinedStereoProcessor : private Thread
+{
+    public:
+        PipelinedStereoProcessor (StereoProcessor<T>& p)
+            : Thread ("Wavechild670 front stage"),
+              processor (p), blockSize (0), next (0), pending (-1),
+              outRead (0), outWrite (0), outSize (0)
+        {}
+        //----------------------------------------------------------------------
+        ~PipelinedStereoProcessor ()
+        {
+            release ();
+        }
+        //----------------------------------------------------------------------
+        // call after processor.init(), not from the audio thread
+        //----------------------------------------------------------------------
+        void prepare (int maxBlockSize)
+        {
+            release ();
+            //------------------------------------------------------------------
+            blockSize = jmax (1, maxBlockSize);
+            for (int k = 0; k < numSlots; ++k) slots[k].allocate (blockSize);
+            //------------------------------------------------------------------
+            outSize = 2*blockSize;
+            outL.allocate (outSize, true); outR.allocate (outSize, true);
+            outRead = 0; outWrite = blockSize; // pre-filled with one block
+            //------------------------------------------------------------------
+            frontQueue.reset (); backQueue.reset ();
+            work.reset (); done.reset ();
+            next = 0; pending = -1;
+            //------------------------------------------------------------------
+            startThread (realtimeAudioPriority);
+        }
+        //----------------------------------------------------------------------
+        // the worker is stopped and the staged parameters applied on return
+        //----------------------------------------------------------------------
+        void release ()
+        {
+            signalThreadShouldExit ();
+            work.post ();
+            stopThread (1000);
+            staged.apply (processor);
+        }
+        //----------------------------------------------------------------------
+        int getLatencySamples () const { return blockSize; }
+        //----------------------------------------------------------------------
+        // any thread: applied at the next block boundary
+        //----------------------------------------------------------------------
+        void setParameter (int index, float value) { staged.set (index, value); }
+        //----------------------------------------------------------------------
+        // between blocks, on the audio thread: the front stage of the queued
+        // block is done on return, so the caller may write the processor
+        // state (snapshot restore) without racing the worker
+        //----------------------------------------------------------------------
+        void settle ()
+        {
+            if (pending >= 0) finish (pending);
+        }
+        //----------------------------------------------------------------------
+        void processBlock (float *left, float *right, int numSamples)
+        {
+            while (numSamples > 0)
+            {
+                const int n = jmin (numSamples, blockSize);
+                processChunk (left, right, n);
+                left += n; right += n; numSamples -= n;
+            }
+        }
+        //----------------------------------------------------------------------
+    private:
+        //----------------------------------------------------------------------
+        enum { numSlots = 3 };
+        enum { idle, queued, running, ready }; // Slot::stage
+        //----------------------------------------------------------------------
+        struct Slot
+        {
+            void allocate (int size)
+            {
+                left.allocate (size, true);  right.allocate (size, true);
+                gateA.allocate (size, true); gateB.allocate (size, true);
+                capA.allocate (size, true);  capB.allocate (size, true);
+                numSamples = 0; feedforward = true;
+                stage = idle;
+            }
+            //------------------------------------------------------------------
+            HeapBlock<float> left, right;
+            HeapBlock<T> gateA, gateB, capA, capB;
+            MeterLevels in;     // input meter, measured by the front stage
+            int numSamples;
+            bool feedforward;
+            Atomic<int> stage;  // who runs the front stage (claimed by CAS)
+        };
+        //----------------------------------------------------------------------
+        StereoProcessor<T>& processor;
+        Slot slots[numSlots];
+        BlockQueue<numSlots> frontQueue, backQueue;
+        Semaphore work, done;   // one post per push on the queue
+        StagedParameters staged;
+        //----------------------------------------------------------------------
+        int blockSize, next, pending;
+        //----------------------------------------------------------------------
+        HeapBlock<float> outL, outR; // output FIFO (audio thread only)
+        int outRead, outWrite, outSize;
+        //----------------------------------------------------------------------
+        void run ()
+        {
+            for (;;)
+            {
+                work.wait ();
+                if (threadShouldExit ()) return;
+                //--------------------------------------------------------------
+                int index;
+                while (frontQueue.pop (index))
+                {
+                    Slot& s = slots[index];
+                    if (! s.stage.compareAndSetBool (running, queued))
+                        continue;           // run by the audio thread
+                    front (s);
+                    backQueue.push (index);
+                    done.post ();
+                }
+            }
+        }
+        //----------------------------------------------------------------------
+        void front (Slot& s)
+        {
+            const SampleBuffer io = SampleBuffer::planar (s.left, s.right,
+                                                          float32Format);
+            processor.readInput (io, 0, s.gateA, s.gateB, s.numSamples);
+            s.in.clear ();
+            if (processor.getMeter () != nullptr)
+                s.in.measure (s.gateA.getData (), s.gateB.getData (), s.numSamples);
+            processor.processFront (s.gateA, s.gateB, s.capA, s.capB,
+                                    s.feedforward, s.numSamples);
+        }
+        //----------------------------------------------------------------------
+        // the front stage of the queued block is done on return: run here
+        // when the worker has not claimed it yet, else wait for its index
+        // on the back queue (exactly one post per block the worker ran)
+        //----------------------------------------------------------------------
+        void finish (int index)
+        {
+            Slot& s = slots[index];
+            if (s.stage.get () == ready) return;   // settled
+            //------------------------------------------------------------------
+            if (s.stage.compareAndSetBool (running, queued)) front (s);
+            else
+            {
+                int finished = -1;
+                done.wait ();
+                backQueue.pop (finished);
+                jassert (finished == index);
+            }
+            s.stage = ready;
+        }
+        //----------------------------------------------------------------------
+        void processChunk (float *left, float *right, int n)
+        {
+            //------------------------------------------------------------------
+            // collect the front stage of the previous block: the worker is
+            // idle until the next push, parameters can change
+            //------------------------------------------------------------------
+            const int index = pending;
+            if (index >= 0) finish (index);
+            staged.apply (processor);
+            //------------------------------------------------------------------
+            Slot& s = slots[next];
+            memcpy (s.left,  left,  n * sizeof (float));
+            memcpy (s.right, right, n * sizeof (float));
+            s.numSamples = n;
+            s.feedforward = !processor.feedback;
+            //------------------------------------------------------------------
+            // both stages would run the sidechain: serialize this one block
+            //------------------------------------------------------------------
+            const bool serial = (index >= 0)
+                             && (slots[index].feedforward != s.feedforward);
+            //------------------------------------------------------------------
+            if (serial) back (index);
+            queue (next);
+            if (!serial && index >= 0) back (index);
+            //------------------------------------------------------------------
+            pending = next; next = (next + 1) % numSlots;
+            //------------------------------------------------------------------
+            int i = 0;
+            for (; i < n; ++i)
+            {
+                left[i] = outL[outRead]; right[i] = outR[outRead];
+                outRead = (outRead + 1) % outSize;
+            }
+        }
+        //----------------------------------------------------------------------
+        // a full front queue (stale indexes of blocks the audio thread ran,
+        // worker starved) leaves the block queued: it is run by finish()
+        //----------------------------------------------------------------------
+        void queue (int index)
+        {
+            slots[index].stage = queued;
+            if (frontQueue.push (index)) work.post ();
+        }
+        //----------------------------------------------------------------------
+        void back (int index)
+        {
+            Slot& s = slots[index];
+            s.stage = idle;
+            const SampleBuffer io = SampleBuffer::planar (s.left, s.right,
+                                                          float32Format);
+            processor.processBack (s.gateA, s.gateB, s.capA, s.capB,
+                                   s.feedforward, s.gateA, s.gateB,
+                                   s.numSamples);
+            //------------------------------------------------------------------
+            // the front stage owns the level caps in feed-forward mode: meter
+            // the values it left for this block
+            //------------------------------------------------------------------
+            if (Meter* meter = processor.getMeter ())
+            {
+                const int last = s.numSamples - 1;
+                meter->input (s.in);
+                meter->output (s.gateA.getData (), s.gateB.getData (),
+                               s.numSamples, processor.gain);
+                if (s.feedforward && last >= 0)
+                     processor.publishMeter (s.capA[last], s.capB[last]);
+                else processor.publishMeter ();
+            }
+            processor.writeOutput (s.gateA, s.gateB, io, 0, s.numSamples);
+            //------------------------------------------------------------------
+            int i = 0;
+            for (; i < s.numSamples; ++i)
+            {
+                outL[outWrite] = s.left[i]; outR[outWrite] = s.right[i];
+                outWrite = (outWrite + 1) % outSize;
+            }
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (PipelinedStereoProcessor)
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_PIPELINED_PROCESSOR_HPP_469B43AE__
+//==============================================================================
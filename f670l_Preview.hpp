@@ -0,0 +1,312 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_PREVIEW_HPP_0D93F6B1__
+#define __F670L_PREVIEW_HPP_0D93F6B1__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_Analysis.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Preview tier
+//------------------------------------------------------------------------------
+// PreviewModel holds what is measured on the full StereoProcessor for each
+// (feedback, time constant) setting:
+//
+//      - static curve: signed fundamental gain vs input level (dB grid)
+//      - dynamics: attack / release of the gain (63% times, level step)
+//      - harmonic signature: h2..h7 at a reference level
+//
+// PreviewProcessor replays it with the StereoProcessor API: peak detector
+// (attack/release) -> gain table -> Chebyshev waveshaper, for a fraction of
+// the cost. measure() reports its error budget against the full model.
+//==============================================================================
+struct PreviewModel
+{
+    enum { numLevels = 36, numHarmonics = 8, numSettings = 6,
+           magic = 0x57363750, version = 1 }; // "W67P"
+    //--------------------------------------------------------------------------
+    static double levelDb (int i) { return -60.0 + 2.0 * i; } // -60 .. +10 dB
+    //--------------------------------------------------------------------------
+    struct Setting
+    {
+        double gain[numLevels];         // signed fundamental gain
+        double attack, release;         // seconds
+        double harmonic[numHarmonics];  // [k], k = 2..7
+        double reference;               // waveshaper reference amplitude
+    };
+    //--------------------------------------------------------------------------
+    double Fs;                          // characterization rate
+    Setting settings[2][numSettings];   // [feedback][time constant]
+    //--------------------------------------------------------------------------
+    void write (OutputStream& out) const
+    {
+        out.writeInt (magic); out.writeInt (version);
+        out.writeDouble (Fs);
+        out.write (settings, sizeof (settings));
+    }
+    //--------------------------------------------------------------------------
+    bool read (InputStream& in)
+    {
+        if (in.readInt () != magic || in.readInt () != version) return false;
+        Fs = in.readDouble ();
+        return in.read (settings, sizeof (settings)) == (int) sizeof (settings);
+    }
+};
+//==============================================================================
+template <typename T>
+class PreviewProcessor
+{
+    public:
+        PreviewProcessor (const PreviewModel& m)
+            : model (m),
+              Fs (44100.0),       gain (1.0),
+              blockSize (0),
+              levelA (1.0),     levelB (1.0),
+          thresholdA (1.0), thresholdB (1.0),
+                 tcA (2),          tcB (2),
+              hardclipout (true),
+                 feedback (false),
+                  midside (false),
+                   linked (true),
+              lastFeedback (false)
+        {}
+        //----------------------------------------------------------------------
+        void init (T sampleRate, int maxBlockSize = 512)
+        {
+            Fs = sampleRate;
+            blockSize = jmax (1, maxBlockSize);
+            chA.reset (); chB.reset ();
+            lastFeedback = feedback;
+            parameters (tcA, tcB);
+        }
+        //----------------------------------------------------------------------
+        void parameters (const int tA, const int tB)
+        {
+            tcA = tA; tcB = tB;
+            chA.setup (model.settings[feedback ? 1 : 0][tcA], Fs);
+            chB.setup (model.settings[feedback ? 1 : 0][tcB], Fs);
+        }
+        //----------------------------------------------------------------------
+        inline void process (float* left, float* right)
+        {
+            const T sqrt2 = 1.4142135623730951;
+            T a = (midside) ? (left[0] + right[0]) / sqrt2 : left[0];
+            T b = (midside) ? (left[0] - right[0]) / sqrt2 : right[0];
+            a *= levelA; b *= levelB;
+            //------------------------------------------------------------------
+            chA.detect (a); chB.detect (b);
+            if (linked) chA.env = chB.env = jmax (chA.env, chB.env);
+            a = chA.gain () * chA.shape (a);
+            b = chB.gain () * chB.shape (b);
+            //------------------------------------------------------------------
+            T L = ((midside) ? (a + b) / sqrt2 : a) * gain;
+            T R = ((midside) ? (a - b) / sqrt2 : b) * gain;
+            if (hardclipout) { L = jlimit ((T) -1.0, (T) 1.0, L);
+                               R = jlimit ((T) -1.0, (T) 1.0, R); }
+            left[0] = (float) L; right[0] = (float) R;
+        }
+        //----------------------------------------------------------------------
+        void processBlock (float* left, float* right, int numSamples)
+        {
+            if (feedback != lastFeedback) { lastFeedback = feedback; parameters (tcA, tcB); }
+            for (int i = 0; i < numSamples; ++i) process (left + i, right + i);
+        }
+        //----------------------------------------------------------------------
+    private:
+        struct Channel
+        {
+            const PreviewModel::Setting* s;
+            T env, att, rel;
+            //------------------------------------------------------------------
+            void reset () { env = 0.0; }
+            void setup (const PreviewModel::Setting& setting, T Fs)
+            {
+                s = &setting;
+                att = 1.0 - exp (-1.0 / (s->attack  * Fs));
+                rel = 1.0 - exp (-1.0 / (s->release * Fs));
+            }
+            //------------------------------------------------------------------
+            inline void detect (T x)
+            {
+                const T r = fabs (x);
+                env += ((r > env) ? att : rel) * (r - env);
+            }
+            //------------------------------------------------------------------
+            inline T gain () const // table, linear in dB
+            {
+                const T u = (Analysis::toDb (env) - PreviewModel::levelDb (0)) / 2.0;
+                if (u <= 0.0) return s->gain[0];
+                if (u >= PreviewModel::numLevels - 1) return s->gain[PreviewModel::numLevels - 1];
+                const int i = (int) u; const T f = u - i;
+                return s->gain[i] + f * (s->gain[i + 1] - s->gain[i]);
+            }
+            //------------------------------------------------------------------
+            inline T shape (T x) const // x + A0 sum h_k T_k (x / A0)
+            {
+                const T A0 = s->reference;
+                const T u = jlimit ((T) -1.0, (T) 1.0, x / A0);
+                T t0 = 1.0, t1 = u, y = 0.0;
+                for (int k = 2; k < PreviewModel::numHarmonics; ++k)
+                {
+                    const T t2 = 2.0*u*t1 - t0;
+                    y += s->harmonic[k] * t2;
+                    t0 = t1; t1 = t2;
+                }
+                return x + A0 * y;
+            }
+        };
+        //----------------------------------------------------------------------
+        const PreviewModel& model;
+        Channel chA, chB;
+        //----------------------------------------------------------------------
+    public:
+        T Fs, gain;
+        int blockSize;
+        T levelA, levelB, thresholdA, thresholdB;
+        int tcA, tcB;
+        bool hardclipout, feedback, midside, linked;
+        //----------------------------------------------------------------------
+    private:
+        bool lastFeedback;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// Offline characterization of the full model (several seconds of simulated
+// audio per level and setting). The detector times are then calibrated so
+// that the preview step response matches the measured one (the gain trace
+// of a peak detector is not a one-pole response of its time constant).
+//==============================================================================
+static void characterize (PreviewModel& m, double Fs, double reference = 0.1,
+                          int block = 512, int calibration = 3)
+{
+    m.Fs = Fs;
+    PreviewProcessor<double> preview (m);
+    for (int fb = 0; fb < 2; ++fb)
+    {
+        for (int tc = 0; tc < PreviewModel::numSettings; ++tc)
+        {
+            PreviewModel::Setting& s = m.settings[fb][tc];
+            StereoProcessor<double> p;
+            p.feedback = (fb != 0);
+            p.init (Fs, block);
+            p.parameters (tc, tc);
+            //------------------------------------------------------------------
+            for (int i = 0; i < PreviewModel::numLevels; ++i) // ascending
+                s.gain[i] = Analysis::toneResponse (p, Fs,
+                                Analysis::fromDb (PreviewModel::levelDb (i))).gain;
+            //------------------------------------------------------------------
+            p.init (Fs, block); p.parameters (tc, tc);
+            const Analysis::ToneResponse r = Analysis::toneResponse (p, Fs, reference);
+            for (int k = 0; k < PreviewModel::numHarmonics; ++k)
+                s.harmonic[k] = r.harmonic[k];
+            s.reference = reference;
+            //------------------------------------------------------------------
+            p.init (Fs, block); p.parameters (tc, tc);
+            const Analysis::StepResponse target = Analysis::stepResponse (p, Fs,
+                                Analysis::fromDb (-30.0), 1.0);
+            s.attack  = jmax (target.attack,  1e-4);
+            s.release = jmax (target.release, 1e-3);
+            //------------------------------------------------------------------
+            preview.feedback = p.feedback;
+            for (int k = 0; k < calibration; ++k)
+            {
+                preview.init (Fs, block); preview.parameters (tc, tc);
+                const Analysis::StepResponse step = Analysis::stepResponse (preview, Fs,
+                                Analysis::fromDb (-30.0), 1.0);
+                if (step.attack > 0.0 && target.attack > 0.0)
+                    s.attack = jmax (s.attack * target.attack / step.attack, 1e-4);
+                if (step.release > 0.0)
+                    s.release = jmax (s.release * target.release / step.release, 1e-3);
+            }
+        }
+    }
+}
+//==============================================================================
+// Error budget of the preview against the full model, per setting
+//==============================================================================
+struct PreviewError
+{
+    double staticDb;        // max |static curve error| over the level grid
+    double attack, release; // relative errors of the step response times
+    double nullDb;          // program residual relative to the full output
+    double gainTraceDb;     // RMS error of the gain trace on program
+    double nsFull, nsPreview;
+};
+//------------------------------------------------------------------------------
+static PreviewError measure (const PreviewModel& model, int feedback, int tc,
+                             double seconds = 6.0, int block = 512)
+{
+    const double Fs = model.Fs;
+    PreviewError e;
+    StereoProcessor<double> full;     full.feedback = (feedback != 0);
+    PreviewProcessor<double> preview (model); preview.feedback = full.feedback;
+    //--------------------------------------------------------------------------
+    e.staticDb = 0.0;
+    for (int i = 0; i < PreviewModel::numLevels; i += 5)
+    {
+        full.init (Fs, block);    full.parameters (tc, tc);
+        preview.init (Fs, block); preview.parameters (tc, tc);
+        const double level = Analysis::fromDb (PreviewModel::levelDb (i));
+        const double a = Analysis::toneResponse (full, Fs, level).gain;
+        const double b = Analysis::toneResponse (preview, Fs, level).gain;
+        e.staticDb = jmax (e.staticDb, fabs (Analysis::toDb (fabs (b) / fabs (a))));
+    }
+    //--------------------------------------------------------------------------
+    full.init (Fs, block);    full.parameters (tc, tc);
+    preview.init (Fs, block); preview.parameters (tc, tc);
+    const Analysis::StepResponse sa = Analysis::stepResponse (full, Fs, Analysis::fromDb (-30.0), 1.0);
+    const Analysis::StepResponse sb = Analysis::stepResponse (preview, Fs, Analysis::fromDb (-30.0), 1.0);
+    e.attack  = fabs (sb.attack  - sa.attack)  / jmax (sa.attack,  1e-4);
+    e.release = fabs (sb.release - sa.release) / jmax (sa.release, 1e-3);
+    //--------------------------------------------------------------------------
+    const int n = (int) (seconds * Fs);
+    HeapBlock<float> x (n), ya (n), yb (n);
+    Analysis::programSignal (x, n, Fs);
+    full.init (Fs, block);    full.parameters (tc, tc);
+    preview.init (Fs, block); preview.parameters (tc, tc);
+    Analysis::render (full, x, ya, n, block);
+    Analysis::render (preview, x, yb, n, block);
+    e.nullDb = Analysis::nullDepth (ya, yb, n);
+    e.gainTraceDb = Analysis::gainTraceError (x, ya, yb, n, (int) (0.01 * Fs));
+    //--------------------------------------------------------------------------
+    e.nsFull    = Analysis::nanosecondsPerSample (full, x, n, block, 1);
+    e.nsPreview = Analysis::nanosecondsPerSample (preview, x, n, block, 1);
+    return e;
+}
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_PREVIEW_HPP_0D93F6B1__
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,342 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_PROCESSING_ENGINE_HPP_3C0E7A51__
+#define __F670L_PROCESSING_ENGINE_HPP_3C0E7A51__
+//==============================================================================
+#include "f670l_StereoProcessor.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Multi-instance processing engine
+//------------------------------------------------------------------------------
+// Owns N StereoProcessor instances and processes one batch of buffers per
+// cycle on a work-stealing pool. The calling thread is worker 0.
+//
+// Each worker owns a contiguous range of tasks packed in a single atomic
+// word (begin:end): the owner takes from the front, thieves take from the
+// back, both with a compare-and-swap, so no lock is ever taken.
+//
+// A task is a group of consecutive compatible instances (same sample rate
+// and block size), run back to back on one core to share its caches.
+//
+// Nothing two workers write shares a cache line: the instances sit in one
+// arena on whole cache lines, their state (amplifiers, time constants, block
+// scratch) in a second one through setArena(), one slot per instance, and
+// the task ranges are padded to a line each. The WDF programs inside the
+// amplifiers still keep their node arrays on the heap (JUCE Arrays, grown
+// at wiring).
+//==============================================================================
+template <typename T>
+class ProcessingEngine
+{
+    public:
+        //----------------------------------------------------------------------
+        struct Buffer
+        {
+            float *left, *right;
+            int numSamples;
+        };
+        //----------------------------------------------------------------------
+        struct Stats
+        {
+            double cycleTime;       // wall time of the last cycle (s)
+            double busyTime;        // sum of task times of the last cycle (s)
+            double overhead;        // cycleTime - busyTime / numWorkers (s)
+            int    steals;          // tasks run by a non-owner worker
+        };
+        //----------------------------------------------------------------------
+        ProcessingEngine (int numInstances, int numThreads = 0)
+            : numSlots (jmax (1, numInstances)),
+              numWorkers (jmax (1, (numThreads > 0) ? numThreads
+                                                    : SystemStats::getNumCpus())),
+              groupSize (1), numTasks (0), stateStride (0), batch (nullptr)
+        {
+            //------------------------------------------------------------------
+            // instances in place in one arena, each on its own cache lines
+            //------------------------------------------------------------------
+            arena.calloc (numSlots * stride () + cacheLineSize);
+            char* base = Arena::align (arena.getData ());
+            for (int i = 0; i < numSlots; ++i)
+                slots.add (new Slot())->processor = new (base + i * stride ())
+                                                        StereoProcessor<T>();
+            //------------------------------------------------------------------
+            tasks.calloc (numSlots + 1);
+            rangeBlock.calloc (numWorkers * sizeof (Range) + cacheLineSize);
+            ranges = (Range*) Arena::align (rangeBlock.getData ());
+            for (int w = 0; w < numWorkers; ++w) new (ranges + w) Range();
+            //------------------------------------------------------------------
+            for (int w = 1; w < numWorkers; ++w)
+                workers.add (new Worker (*this, w));
+            stats.cycleTime = stats.busyTime = stats.overhead = 0.0;
+            stats.steals = 0;
+        }
+        //----------------------------------------------------------------------
+        ~ProcessingEngine ()
+        {
+            for (int w = 0; w < workers.size(); ++w)
+                workers[w]->signalThreadShouldExit ();
+            for (int w = 0; w < workers.size(); ++w)
+            {
+                workers[w]->start.signal ();
+                workers[w]->stopThread (1000);
+            }
+            for (int i = 0; i < numSlots; ++i)
+                slots[i]->processor->~StereoProcessor<T>();
+            for (int w = 0; w < numWorkers; ++w) ranges[w].~Range();
+        }
+        //----------------------------------------------------------------------
+        int getNumInstances () const { return numSlots; }
+        int getNumWorkers () const { return numWorkers; }
+        //----------------------------------------------------------------------
+        StereoProcessor<T>& getInstance (int i)
+        {
+            jassert (i >= 0 && i < numSlots);
+            return *slots[i]->processor;
+        }
+        //----------------------------------------------------------------------
+        // not from the processing thread (warm = false skips the warmup of
+        // every instance, the caller then feeds them silence first)
+        //----------------------------------------------------------------------
+        void init (T sampleRate, int maxBlockSize, bool warm = true)
+        {
+            //------------------------------------------------------------------
+            // one state slot per instance, sized for the block size
+            //------------------------------------------------------------------
+            const size_t bytes = StereoProcessor<T>::stateSize (maxBlockSize);
+            if (bytes != stateStride)
+            {
+                for (int i = 0; i < numSlots; ++i)
+                    slots[i]->processor->setArena (nullptr);
+                stateStride = bytes;
+                state.calloc (numSlots * stateStride + cacheLineSize);
+                char* base = Arena::align (state.getData ());
+                for (int i = 0; i < numSlots; ++i)
+                {
+                    slots[i]->state.assign (base + i * stateStride, stateStride);
+                    slots[i]->processor->setArena (&slots[i]->state);
+                }
+            }
+            //------------------------------------------------------------------
+            for (int i = 0; i < numSlots; ++i)
+            {
+                slots[i]->processor->init (sampleRate, maxBlockSize, warm);
+                slots[i]->maxBlockSize = maxBlockSize;
+            }
+            buildTasks ();
+            //------------------------------------------------------------------
+            for (int w = 0; w < workers.size(); ++w)
+                if (! workers[w]->isThreadRunning ())
+                    workers[w]->startThread (realtimeAudioPriority);
+        }
+        //----------------------------------------------------------------------
+        // at most groupSize compatible instances per task (1 = no grouping)
+        //----------------------------------------------------------------------
+        void setGroupSize (int size)
+        {
+            groupSize = jmax (1, size);
+            buildTasks ();
+        }
+        //----------------------------------------------------------------------
+        // processes buffers[0..numInstances-1], returns when all are done
+        //----------------------------------------------------------------------
+        void process (const Buffer* buffers)
+        {
+            const int64 t0 = Time::getHighResolutionTicks ();
+            //------------------------------------------------------------------
+            batch = buffers;
+            busyTicks = 0; steals = 0;
+            remaining = numTasks;
+            //------------------------------------------------------------------
+            for (int w = 0; w < numWorkers; ++w)
+            {
+                const int begin = (numTasks *  w     ) / numWorkers;
+                const int end   = (numTasks * (w + 1)) / numWorkers;
+                ranges[w].value = pack (begin, end);
+            }
+            for (int w = 0; w < workers.size(); ++w) workers[w]->start.signal ();
+            //------------------------------------------------------------------
+            work (0);
+            finished.wait (-1);     // signalled by the last task
+            //------------------------------------------------------------------
+            const int64 t1 = Time::getHighResolutionTicks ();
+            stats.cycleTime = Time::highResolutionTicksToSeconds (t1 - t0);
+            stats.busyTime = Time::highResolutionTicksToSeconds (busyTicks.get());
+            stats.overhead = stats.cycleTime - stats.busyTime / numWorkers;
+            stats.steals = steals.get();
+        }
+        //----------------------------------------------------------------------
+        const Stats& getStats () const { return stats; }
+        //----------------------------------------------------------------------
+    private:
+        //----------------------------------------------------------------------
+        enum { cacheLineSize = Arena::cacheLineSize };
+        //----------------------------------------------------------------------
+        // instance size rounded up to whole cache lines
+        //----------------------------------------------------------------------
+        static size_t stride ()
+        {
+            return (sizeof (StereoProcessor<T>) + cacheLineSize - 1)
+                   & ~(size_t) (cacheLineSize - 1);
+        }
+        //----------------------------------------------------------------------
+        struct Slot
+        {
+            Slot () : processor (nullptr), maxBlockSize (0) {}
+            //------------------------------------------------------------------
+            StereoProcessor<T>* processor;  // in the arena
+            Arena state;                    // its slot of the state block
+            int maxBlockSize;
+        };
+        //----------------------------------------------------------------------
+        struct Range
+        {
+            Atomic<int64> value;
+            char pad[cacheLineSize - sizeof (Atomic<int64>)];
+        };
+        //----------------------------------------------------------------------
+        class Worker : public Thread
+        {
+            public:
+                Worker (ProcessingEngine& e, int i)
+                    : Thread ("Wavechild670 engine worker"), engine (e), index (i) {}
+                //--------------------------------------------------------------
+                void run ()
+                {
+                    while (! threadShouldExit ())
+                    {
+                        start.wait (-1);
+                        if (threadShouldExit ()) break;
+                        engine.work (index);
+                    }
+                }
+                //--------------------------------------------------------------
+                WaitableEvent start;
+                //--------------------------------------------------------------
+            private:
+                ProcessingEngine& engine;
+                const int index;
+        };
+        //----------------------------------------------------------------------
+        HeapBlock<char> arena; // StereoProcessor instances, see stride()
+        HeapBlock<char> state; // their state, stateStride bytes each
+        OwnedArray<Slot> slots;
+        HeapBlock<int> tasks; // first instance of each task, plus end marker
+        HeapBlock<char> rangeBlock;
+        Range* ranges;        // in rangeBlock, one cache line each
+        OwnedArray<Worker> workers;
+        //----------------------------------------------------------------------
+        const int numSlots, numWorkers;
+        int groupSize, numTasks;
+        size_t stateStride;
+        const Buffer* batch;
+        //----------------------------------------------------------------------
+        Atomic<int> remaining, steals;
+        Atomic<int64> busyTicks;
+        WaitableEvent finished;
+        Stats stats;
+        //----------------------------------------------------------------------
+        static inline int64 pack (int begin, int end)
+        {
+            return (int64 (begin) << 32) | (int64) (uint32) end;
+        }
+        //----------------------------------------------------------------------
+        void buildTasks ()
+        {
+            numTasks = 0;
+            int i = 0;
+            while (i < numSlots)
+            {
+                tasks[numTasks++] = i;
+                const StereoProcessor<T>& first = *slots[i]->processor;
+                int n = 1;
+                while (n < groupSize && i + n < numSlots
+                       && slots[i + n]->processor->Fs == first.Fs
+                       && slots[i + n]->maxBlockSize == slots[i]->maxBlockSize)
+                    ++n;
+                i += n;
+            }
+            tasks[numTasks] = numSlots;
+        }
+        //----------------------------------------------------------------------
+        // take one task from the front (owner) or the back (thief) of a range
+        //----------------------------------------------------------------------
+        bool take (int w, bool fromFront, int& task)
+        {
+            for (;;)
+            {
+                const int64 r = ranges[w].value.get();
+                const int begin = (int) (r >> 32);
+                const int end   = (int) (uint32) r;
+                if (begin >= end) return false;
+                //--------------------------------------------------------------
+                task = fromFront ? begin : end - 1;
+                const int64 taken = fromFront ? pack (begin + 1, end)
+                                              : pack (begin, end - 1);
+                if (ranges[w].value.compareAndSetBool (taken, r)) return true;
+            }
+        }
+        //----------------------------------------------------------------------
+        void work (int w)
+        {
+            int task;
+            while (take (w, true, task)) runTask (task);
+            //------------------------------------------------------------------
+            for (int k = 1; k < numWorkers; ++k)
+            {
+                const int victim = (w + k) % numWorkers;
+                while (take (victim, false, task)) { runTask (task); ++steals; }
+            }
+        }
+        //----------------------------------------------------------------------
+        void runTask (int task)
+        {
+            const int64 t0 = Time::getHighResolutionTicks ();
+            //------------------------------------------------------------------
+            int i = tasks[task];
+            for (; i < tasks[task + 1]; ++i)
+            {
+                const Buffer& b = batch[i];
+                slots[i]->processor->processBlock (b.left, b.right, b.numSamples);
+            }
+            //------------------------------------------------------------------
+            busyTicks += Time::getHighResolutionTicks () - t0;
+            if (--remaining == 0) finished.signal ();
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (ProcessingEngine)
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_PROCESSING_ENGINE_HPP_3C0E7A51__
+//==============================================================================
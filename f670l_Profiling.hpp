@@ -0,0 +1,258 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_PROFILING_HPP_8F1D6B27__
+#define __F670L_PROFILING_HPP_8F1D6B27__
+//==============================================================================
+// Per-stage CPU profiling
+//------------------------------------------------------------------------------
+// With WAVECHILD670_PROFILE=1, StereoProcessor times its stages (input,
+// transformers, push/pull tubes, sidechain, output) with the time stamp
+// counter, sums them per block and pushes one BlockProfile per block into
+// the lock-free ring of the Profiler attached with setProfiler(). Without
+// the flag the scopes compile to nothing (the profiler pointer stays,
+// unused).
+//
+// Each scope covers a whole loop over the block, never a single sample (two
+// counter reads per sample would outweigh the cheaper stages). Stages that
+// are coupled sample by sample are timed together: the sidechain amplifiers
+// with the time constant networks (the level caps feed the detectors), and
+// in feedback mode the tubes with the whole sidechain.
+//
+//      Profiling::Profiler profiler;                   // not on the stack
+//      processor.setProfiler (&profiler);
+//      ...
+//      profiler.read (records, max);                   // live, any thread
+//      Profiling::writeChromeTrace (stream, records, n); // chrome://tracing
+//
+// One writer per Profiler: give each processor (thread) its own, and none
+// to a processor driven by PipelinedStereoProcessor (two threads per block).
+// Wavechild670Render --trace exports the profile of an offline render.
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#if defined (__i386__) || defined (__x86_64__) || defined (_M_IX86) || defined (_M_X64)
+ #include <x86intrin.h>
+ #define WAVECHILD670_PROFILE_TSC 1
+#else
+ #define WAVECHILD670_PROFILE_TSC 0
+#endif
+//==============================================================================
+#ifndef WAVECHILD670_PROFILE
+ #define WAVECHILD670_PROFILE 0
+#endif
+//==============================================================================
+namespace Wavechild670 {
+namespace Profiling {
+//==============================================================================
+enum Stage
+{
+    inputStage, transformerStage, tubeStage, sidechainStage,
+    feedbackStage, outputStage, numStages
+};
+//------------------------------------------------------------------------------
+static inline const char* stageName (int stage)
+{
+    static const char* names[numStages] = { "input", "transformers",
+        "push/pull tubes", "sidechain + time constant",
+        "tubes + sidechain (feedback)", "output" };
+    return (stage >= 0 && stage < numStages) ? names[stage] : "?";
+}
+//------------------------------------------------------------------------------
+static inline uint64 ticks ()
+{
+   #if WAVECHILD670_PROFILE_TSC
+    return __rdtsc ();
+   #else
+    return (uint64) Time::getHighResolutionTicks ();
+   #endif
+}
+//------------------------------------------------------------------------------
+// tick rate, measured once against the high resolution clock (~20 ms, call
+// it from the reader side)
+//------------------------------------------------------------------------------
+static double ticksPerSecond ()
+{
+   #if WAVECHILD670_PROFILE_TSC
+    static double rate = 0.0;
+    if (rate == 0.0)
+    {
+        const int64 h0 = Time::getHighResolutionTicks ();
+        const uint64 t0 = ticks ();
+        while (Time::highResolutionTicksToSeconds (
+                   Time::getHighResolutionTicks () - h0) < 0.02) {}
+        const double dt = Time::highResolutionTicksToSeconds (
+                              Time::getHighResolutionTicks () - h0);
+        rate = (ticks () - t0) / dt;
+    }
+    return rate;
+   #else
+    return (double) Time::getHighResolutionTicksPerSecond ();
+   #endif
+}
+//==============================================================================
+struct BlockProfile
+{
+    uint64 start, end;          // ticks
+    uint64 stage[numStages];    // ticks spent per stage in the block
+    int numSamples;
+};
+//==============================================================================
+class Profiler
+{
+    public:
+        enum { capacity = 4096 };   // blocks
+        //----------------------------------------------------------------------
+        Profiler () : fifo (capacity + 1), depth (0)
+        {
+            zeromem (&current, sizeof (current));
+        }
+        //----------------------------------------------------------------------
+        // writer (the processing thread), wait-free: a full ring drops
+        //----------------------------------------------------------------------
+        inline void beginBlock (int numSamples)
+        {
+            if (depth++ > 0) return;
+            zeromem (current.stage, sizeof (current.stage));
+            current.numSamples = numSamples;
+            current.start = ticks ();
+        }
+        //----------------------------------------------------------------------
+        inline void endBlock ()
+        {
+            if (--depth > 0) return;
+            current.end = ticks ();
+            int s1, n1, s2, n2;
+            fifo.prepareToWrite (1, s1, n1, s2, n2);
+            if (n1 + n2 == 0) { ++dropped; return; }
+            records[(n1 > 0) ? s1 : s2] = current;
+            fifo.finishedWrite (1);
+        }
+        //----------------------------------------------------------------------
+        inline void add (int stage, uint64 t) { current.stage[stage] += t; }
+        //----------------------------------------------------------------------
+        // reader (one thread): pops up to max blocks, oldest first
+        //----------------------------------------------------------------------
+        int read (BlockProfile* out, int max)
+        {
+            int s1, n1, s2, n2;
+            fifo.prepareToRead (max, s1, n1, s2, n2);
+            for (int i = 0; i < n1; ++i) out[i]      = records[s1 + i];
+            for (int i = 0; i < n2; ++i) out[n1 + i] = records[s2 + i];
+            fifo.finishedRead (n1 + n2);
+            return n1 + n2;
+        }
+        //----------------------------------------------------------------------
+        int getDropped () const { return dropped.get (); }
+        //----------------------------------------------------------------------
+    private:
+        AbstractFifo fifo;
+        BlockProfile records[capacity + 1];
+        BlockProfile current;           // writer only
+        int depth;
+        Atomic<int> dropped;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Profiler)
+};
+//==============================================================================
+class StageScope
+{
+    public:
+        StageScope (Profiler* p, int s) : profiler (p), stage (s),
+                                          t0 ((p != nullptr) ? ticks () : 0) {}
+        ~StageScope () { if (profiler != nullptr) profiler->add (stage, ticks () - t0); }
+    private:
+        Profiler* profiler;
+        int stage;
+        uint64 t0;
+};
+//------------------------------------------------------------------------------
+class BlockScope
+{
+    public:
+        BlockScope (Profiler* p, int n) : profiler (p)
+        {
+            if (profiler != nullptr) profiler->beginBlock (n);
+        }
+        ~BlockScope () { if (profiler != nullptr) profiler->endBlock (); }
+    private:
+        Profiler* profiler;
+};
+//==============================================================================
+// Chrome trace / Perfetto JSON (trace event format). Each block is a
+// complete event; its stages are aggregated over the block, so they are
+// laid out back to back from the block start, with their share of it.
+//==============================================================================
+static void writeChromeTrace (OutputStream& out, const BlockProfile* blocks,
+                              int numBlocks, int pid = 1, int tid = 1)
+{
+    const double us = 1e6 / ticksPerSecond ();
+    const uint64 origin = (numBlocks > 0) ? blocks[0].start : 0;
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (int b = 0; b < numBlocks; ++b)
+    {
+        const BlockProfile& p = blocks[b];
+        double t = (p.start - origin) * us;
+        out << (first ? "" : ",\n")
+            << "{\"name\":\"block\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+            << ",\"ts\":" << String (t, 3) << ",\"dur\":" << String ((p.end - p.start) * us, 3)
+            << ",\"args\":{\"samples\":" << p.numSamples << "}}";
+        first = false;
+        for (int s = 0; s < numStages; ++s)
+        {
+            if (p.stage[s] == 0) continue;
+            const double d = p.stage[s] * us;
+            out << ",\n{\"name\":\"" << stageName (s) << "\",\"ph\":\"X\",\"pid\":" << pid
+                << ",\"tid\":" << tid << ",\"ts\":" << String (t, 3)
+                << ",\"dur\":" << String (d, 3) << "}";
+            t += d;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+//==============================================================================
+} // namespace Profiling
+} // namespace Wavechild670
+//==============================================================================
+#if WAVECHILD670_PROFILE
+ #define WAVECHILD670_PROFILE_BLOCK(profiler, n) \
+    const Wavechild670::Profiling::BlockScope JUCE_JOIN_MACRO (profBlock_, __LINE__) (profiler, n)
+ #define WAVECHILD670_PROFILE_STAGE(profiler, stage) \
+    const Wavechild670::Profiling::StageScope JUCE_JOIN_MACRO (profStage_, __LINE__) \
+        (profiler, Wavechild670::Profiling::stage)
+#else
+ #define WAVECHILD670_PROFILE_BLOCK(profiler, n)
+ #define WAVECHILD670_PROFILE_STAGE(profiler, stage)
+#endif
+//==============================================================================
+#endif  // __F670L_PROFILING_HPP_8F1D6B27__
+//==============================================================================
\ No newline at end of file
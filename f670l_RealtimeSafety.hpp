@@ -0,0 +1,333 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_REALTIME_SAFETY_HPP_3B7E05C1__
+#define __F670L_REALTIME_SAFETY_HPP_3B7E05C1__
+//==============================================================================
+// Real-time safety checks
+//------------------------------------------------------------------------------
+// With WAVECHILD670_REALTIME_CHECK=1 (Linux, glibc), heap allocation, mutex
+// and condition variable calls, and blocking system calls made by a thread
+// inside a Realtime::Scope are recorded as violations. Define
+// WAVECHILD670_REALTIME_CHECK_IMPLEMENTATION in exactly one translation unit
+// to install the interposers (malloc family, pthread, read/write/open/sleep,
+// syscall). Without the flag the scopes compile to nothing.
+//
+//      WAVECHILD670_REALTIME_SCOPE;                // audio callback body
+//      WAVECHILD670_REALTIME_ALLOW ("reason");     // known, bounded exception
+//
+// Realtime::Harness drives a StereoProcessor through every mode flag,
+// solver setting and time constant change inside a scope and reports the
+// violations (test program: Wavechild670RealtimeTest).
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_Governor.hpp"
+#include "f670l_Capture.hpp"
+//==============================================================================
+#ifndef WAVECHILD670_REALTIME_CHECK
+ #define WAVECHILD670_REALTIME_CHECK 0
+#endif
+//==============================================================================
+namespace Wavechild670 {
+namespace Realtime {
+//==============================================================================
+#if WAVECHILD670_REALTIME_CHECK
+//------------------------------------------------------------------------------
+struct Violations
+{
+    Atomic<int> count;
+    const char* volatile first;     // static strings only (no allocation)
+    const char* volatile where;
+};
+//------------------------------------------------------------------------------
+static inline Violations& violations () { static Violations v; return v; }
+//------------------------------------------------------------------------------
+struct ThreadState { int depth, allowed; const char* where; };
+static inline ThreadState& threadState ()
+{
+    static __thread ThreadState s = { 0, 0, nullptr };
+    return s;
+}
+//------------------------------------------------------------------------------
+// called by the interposers
+//------------------------------------------------------------------------------
+static inline void report (const char* what)
+{
+    ThreadState& s = threadState ();
+    if (s.depth == 0 || s.allowed > 0) return;
+    Violations& v = violations ();
+    if (++v.count == 1) { v.first = what; v.where = s.where; }
+}
+//==============================================================================
+class Scope
+{
+    public:
+        Scope (const char* where = "audio thread")
+        {
+            ThreadState& s = threadState ();
+            if (s.depth++ == 0) s.where = where;
+        }
+        ~Scope () { --threadState().depth; }
+};
+//------------------------------------------------------------------------------
+class Allow
+{
+    public:
+        Allow (const char* /*reason*/) { ++threadState().allowed; }
+        ~Allow () { --threadState().allowed; }
+};
+//------------------------------------------------------------------------------
+static inline int  getViolationCount () { return violations().count.get(); }
+static inline const char* getFirstViolation () { return violations().first; }
+static inline const char* getFirstViolationScope () { return violations().where; }
+static inline void resetViolations ()
+{
+    violations().count = 0; violations().first = violations().where = nullptr;
+}
+//------------------------------------------------------------------------------
+#define WAVECHILD670_REALTIME_SCOPE \
+    const Wavechild670::Realtime::Scope JUCE_JOIN_MACRO (rtScope_, __LINE__) (__FUNCTION__)
+#define WAVECHILD670_REALTIME_ALLOW(reason) \
+    const Wavechild670::Realtime::Allow JUCE_JOIN_MACRO (rtAllow_, __LINE__) (reason)
+//------------------------------------------------------------------------------
+#else
+//------------------------------------------------------------------------------
+static inline int  getViolationCount () { return 0; }
+static inline const char* getFirstViolation () { return nullptr; }
+static inline const char* getFirstViolationScope () { return nullptr; }
+static inline void resetViolations () {}
+//------------------------------------------------------------------------------
+#define WAVECHILD670_REALTIME_SCOPE
+#define WAVECHILD670_REALTIME_ALLOW(reason)
+//------------------------------------------------------------------------------
+#endif
+//==============================================================================
+// Harness: inside a scope, every combination of the mode flags (feedback,
+// mid/side, linked, output clip, diode bridge, quiet early-out) and sidechain
+// antialiasing order, while the other settings step through their values
+// case by case: time constants (every A/B pair), output clip antialiasing,
+// Newton predictor, small-signal tolerance, metering on/off and a governor
+// that degrades (tiny budget) or recovers. Blocks alternate between loud
+// and quiet input (sidechain early-out on and off), through the block and
+// per-sample paths, and are logged by the recorder when one is given
+// (started by the caller). Returns the number of violations (0 = safe).
+//==============================================================================
+class Harness
+{
+    public:
+        static int run (StereoProcessor<double>& processor, int blocksPerCase = 4,
+                        Capture::Recorder* recorder = nullptr)
+        {
+            const int n = processor.blockSize;
+            HeapBlock<float> left (n), right (n);   // allocated before the scope
+            float parameters[numParameters];
+            Meter meter, *const previous = processor.getMeter ();
+            Governor<double> governor (processor);
+            governor.setHysteresis (1.0, 1);
+            resetViolations ();
+            //------------------------------------------------------------------
+            for (int mode = 0; mode < 64 * 3; ++mode)
+            {
+                for (int tc = 0; tc < 6; ++tc)
+                {
+                    WAVECHILD670_REALTIME_SCOPE;
+                    const int c = mode * 6 + tc;
+                    //----------------------------------------------------------
+                    processor.feedback    = (mode & 1) != 0;
+                    processor.midside     = (mode & 2) != 0;
+                    processor.linked      = (mode & 4) != 0;
+                    processor.hardclipout = (mode & 8) != 0;
+                    processor.setDiodeBridge ((mode & 16) != 0);
+                    processor.setQuietTolerance ((mode & 32) ? 1e-9 : 0.0);
+                    processor.setAntialiasing (mode / 64);
+                    processor.setClipAntialiasing (c % 3);
+                    processor.parameters (tc, (tc + mode) % 6);
+                    //----------------------------------------------------------
+                    processor.setPredictor (c % WDF::numPredictors);
+                    processor.setLinearTolerance ((c & 4) ? 1e-4 : 0.0);
+                    processor.setMeter ((c & 8) ? &meter : nullptr);
+                    governor.setBudget ((c & 16) ? 0.01 : 1.0);
+                    //----------------------------------------------------------
+                    for (int b = 0; b < blocksPerCase; ++b)
+                    {
+                        const double level = (b & 1) ? 1e-4 : 1.0;
+                        fill (left, right, n, c + b, level);
+                        if (recorder != nullptr)
+                        {
+                            for (int p = 0; p < numParameters; ++p)
+                                parameters[p] = (float) ((c + p) % 7) / 6.0f;
+                            recorder->block (left, right, n, parameters);
+                        }
+                        governor.processBlock (left, right, n);
+                        processor.process (left, right);
+                    }
+                }
+            }
+            processor.setMeter (previous);
+            return getViolationCount ();
+        }
+        //----------------------------------------------------------------------
+    private:
+        static void fill (float* l, float* r, int n, int seed, double level)
+        {
+            const double w = 0.01 + 0.001 * (seed % 37);
+            for (int i = 0; i < n; ++i)
+            {
+                l[i] = (float) (0.8 * level * sin (w * (seed * n + i)));
+                r[i] = (float) (0.5 * level * sin (1.7 * w * (seed * n + i)));
+            }
+        }
+};
+//==============================================================================
+} // namespace Realtime
+} // namespace Wavechild670
+//==============================================================================
+// Interposers (one translation unit)
+//==============================================================================
+#if WAVECHILD670_REALTIME_CHECK && defined (WAVECHILD670_REALTIME_CHECK_IMPLEMENTATION)
+//------------------------------------------------------------------------------
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <time.h>
+#include <fcntl.h>
+//------------------------------------------------------------------------------
+extern "C" {
+void* __libc_malloc (size_t);
+void* __libc_calloc (size_t, size_t);
+void* __libc_realloc (void*, size_t);
+void* __libc_memalign (size_t, size_t);
+void  __libc_free (void*);
+}
+//------------------------------------------------------------------------------
+namespace Wavechild670 { namespace Realtime {
+//------------------------------------------------------------------------------
+template <typename F>
+static inline F next (F& f, const char* name)
+{
+    if (f == nullptr)
+    {
+        // the condition variables have an old compat version as well
+        if (strncmp (name, "pthread_cond_", 13) == 0)
+            f = (F) dlvsym (RTLD_NEXT, name, "GLIBC_2.3.2");
+        if (f == nullptr) f = (F) dlsym (RTLD_NEXT, name);
+    }
+    return f;
+}
+//------------------------------------------------------------------------------
+#define WC670_RT_FORWARD(ret, name, params, args)                           \
+    extern "C" ret name params                                              \
+    {                                                                       \
+        static ret (*real) params = nullptr;                                \
+        Wavechild670::Realtime::report (#name);                             \
+        return Wavechild670::Realtime::next (real, #name) args;             \
+    }
+//------------------------------------------------------------------------------
+// resolved once at load time, outside any scope (dlsym may allocate)
+//------------------------------------------------------------------------------
+struct Resolver { Resolver (); };
+}} // namespace Wavechild670::Realtime
+//------------------------------------------------------------------------------
+extern "C" void* malloc (size_t n)
+{ Wavechild670::Realtime::report ("malloc"); return __libc_malloc (n); }
+extern "C" void* calloc (size_t n, size_t s)
+{ Wavechild670::Realtime::report ("calloc"); return __libc_calloc (n, s); }
+extern "C" void* realloc (void* p, size_t n)
+{ Wavechild670::Realtime::report ("realloc"); return __libc_realloc (p, n); }
+extern "C" void* memalign (size_t a, size_t n)
+{ Wavechild670::Realtime::report ("memalign"); return __libc_memalign (a, n); }
+extern "C" void* aligned_alloc (size_t a, size_t n)
+{ Wavechild670::Realtime::report ("aligned_alloc"); return __libc_memalign (a, n); }
+extern "C" int posix_memalign (void** p, size_t a, size_t n)
+{
+    Wavechild670::Realtime::report ("posix_memalign");
+    *p = __libc_memalign (a, n);
+    return (*p != nullptr) ? 0 : ENOMEM;
+}
+extern "C" void free (void* p)
+{ if (p != nullptr) Wavechild670::Realtime::report ("free"); __libc_free (p); }
+//------------------------------------------------------------------------------
+WC670_RT_FORWARD (int, pthread_mutex_lock,    (pthread_mutex_t* m), (m))
+WC670_RT_FORWARD (int, pthread_mutex_trylock, (pthread_mutex_t* m), (m))
+WC670_RT_FORWARD (int, pthread_cond_wait,     (pthread_cond_t* c, pthread_mutex_t* m), (c, m))
+WC670_RT_FORWARD (int, pthread_cond_timedwait,(pthread_cond_t* c, pthread_mutex_t* m,
+                                               const struct timespec* t), (c, m, t))
+WC670_RT_FORWARD (int, pthread_cond_signal,   (pthread_cond_t* c), (c))
+WC670_RT_FORWARD (int, pthread_cond_broadcast,(pthread_cond_t* c), (c))
+WC670_RT_FORWARD (ssize_t, read,  (int fd, void* b, size_t n), (fd, b, n))
+WC670_RT_FORWARD (ssize_t, write, (int fd, const void* b, size_t n), (fd, b, n))
+WC670_RT_FORWARD (int, close,     (int fd), (fd))
+WC670_RT_FORWARD (int, nanosleep, (const struct timespec* a, struct timespec* b), (a, b))
+WC670_RT_FORWARD (int, usleep,    (useconds_t u), (u))
+WC670_RT_FORWARD (int, sched_yield, (), ())
+//------------------------------------------------------------------------------
+extern "C" int open (const char* path, int flags, ...)
+{
+    static int (*real) (const char*, int, ...) = nullptr;
+    Wavechild670::Realtime::report ("open");
+    int mode = 0;
+    if (flags & O_CREAT) { va_list l; va_start (l, flags); mode = va_arg (l, int); va_end (l); }
+    return Wavechild670::Realtime::next (real, "open") (path, flags, mode);
+}
+//------------------------------------------------------------------------------
+extern "C" long syscall (long number, ...)
+{
+    static long (*real) (long, ...) = nullptr;
+    Wavechild670::Realtime::report ("syscall");
+    va_list l; va_start (l, number);
+    long a[6]; for (int i = 0; i < 6; ++i) a[i] = va_arg (l, long);
+    va_end (l);
+    return Wavechild670::Realtime::next (real, "syscall")
+                (number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+//------------------------------------------------------------------------------
+Wavechild670::Realtime::Resolver::Resolver ()
+{
+    pthread_mutex_t m = PTHREAD_MUTEX_INITIALIZER;  // forces every lookup
+    pthread_mutex_lock (&m); pthread_mutex_trylock (&m);
+    pthread_mutex_unlock (&m);
+    pthread_cond_t c = PTHREAD_COND_INITIALIZER;
+    pthread_cond_signal (&c); pthread_cond_broadcast (&c);
+    sched_yield ();
+    struct timespec t = { 0, 0 }; nanosleep (&t, nullptr); usleep (0);
+    write (-1, nullptr, 0); read (-1, nullptr, 0); close (-1);
+    ::open ("", O_RDONLY);
+    syscall (-1);
+}
+static Wavechild670::Realtime::Resolver wc670RealtimeResolver;
+//------------------------------------------------------------------------------
+#undef WC670_RT_FORWARD
+#endif
+//==============================================================================
+#endif  // __F670L_REALTIME_SAFETY_HPP_3B7E05C1__
+//==============================================================================
\ No newline at end of file
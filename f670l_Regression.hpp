@@ -0,0 +1,323 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_REGRESSION_HPP_B5E8A14C__
+#define __F670L_REGRESSION_HPP_B5E8A14C__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_Governor.hpp"
+#include "f670l_Analysis.hpp"
+//==============================================================================
+namespace Wavechild670 {
+namespace Regression {
+//==============================================================================
+// Accuracy versus speed harness
+//------------------------------------------------------------------------------
+// Fixed stimuli go through a reference configuration of StereoProcessor:
+// tight Newton tolerance, no antiderivative antialiasing (no stage delays
+// the signal), and run at oversampling x the rate (stimuli are synthesized
+// at the high rate, the output is decimated by a linear phase FIR whose
+// delay is compensated). Reference outputs are golden files committed with
+// the sources, rewritten only on request. Every fast mode is rendered at
+// the base rate and compared with the reference: null residual, THD
+// delta, gain-trace error, ns/sample and the Newton iteration counts
+// (mean, worst and histogram). The output clip antialiasing delays the
+// mode by order/2 samples: the reference is delayed as much before the
+// comparison.
+//==============================================================================
+enum StimulusKind { toneKind, stepKind, programKind };
+//------------------------------------------------------------------------------
+struct Stimulus
+{
+    const char* name;
+    StimulusKind kind;
+    double seconds, level, freq;
+};
+//------------------------------------------------------------------------------
+static const Stimulus stimuli[] =
+{
+    { "tone-20dB", toneKind,    2.0, 0.1,   1000.0 },
+    { "tone-6dB",  toneKind,    2.0, 0.5,   1000.0 },
+    { "tone0dB",   toneKind,    2.0, 1.0,    100.0 },
+    { "step",      stepKind,    4.0, 1.0,   1000.0 },
+    { "program",   programKind, 6.0, 1.0,      0.0 }
+};
+enum { numStimuli = sizeof (stimuli) / sizeof (stimuli[0]) };
+//------------------------------------------------------------------------------
+// the stimulus is a function of time: same signal at any rate. Onsets and
+// level steps are 5 ms raised cosine ramps (nearly band limited, so the
+// decimated reference does not ring)
+//------------------------------------------------------------------------------
+static inline double ramp (double t, double t0)
+{
+    const double u = jlimit (0.0, 1.0, (t - t0) / 0.005);
+    return 0.5 - 0.5 * cos (double_Pi * u);
+}
+//------------------------------------------------------------------------------
+static void synthesize (const Stimulus& s, float* x, int n, double Fs)
+{
+    switch (s.kind)
+    {
+        case toneKind:    Analysis::tone (x, n, s.freq, Fs, s.level); break;
+        case stepKind:    Analysis::tone (x, n, s.freq, Fs, s.level); break;
+        case programKind: Analysis::programSignal (x, n, Fs, 0.01, s.level); break;
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        const double t = i / Fs;
+        double g = ramp (t, 0.0);
+        if (s.kind == stepKind) // -30 dB, 0 dB from 1 s, -30 dB from 2 s
+            g *= 0.03 + 0.97 * (ramp (t, 1.0) - ramp (t, 2.0));
+        x[i] *= (float) g;
+    }
+}
+//==============================================================================
+// Modes under test (applied to a freshly initialized processor)
+//==============================================================================
+struct Mode
+{
+    const char* name;
+    int tier;           // governor solver tier
+    int antialiasing;   // sidechain order
+    int clipAntialiasing;
+    bool diodeBridge;
+    int predictor;      // WDF::NewtonPredictor
+    bool linear;        // small-signal fast path (tier tolerance)
+};
+//------------------------------------------------------------------------------
+static const Mode modes[] =
+{
+    { "default",            0, 0, 0, false, WDF::holdPredictor,        true  },
+    { "solver-high",        1, 0, 0, false, WDF::holdPredictor,        true  },
+    { "solver-medium",      2, 0, 0, false, WDF::holdPredictor,        true  },
+    { "solver-low",         3, 0, 0, false, WDF::holdPredictor,        true  },
+    { "aa-1",               0, 1, 0, false, WDF::holdPredictor,        true  },
+    { "aa-2",               0, 2, 0, false, WDF::holdPredictor,        true  },
+    { "clip-aa-1",          0, 0, 1, false, WDF::holdPredictor,        true  },
+    { "clip-aa-2",          0, 0, 2, false, WDF::holdPredictor,        true  },
+    { "diode-bridge",       0, 0, 0, true,  WDF::holdPredictor,        true  },
+    { "predict-linear",     0, 0, 0, false, WDF::linearPredictor,      true  },
+    { "predict-quadratic",  0, 0, 0, false, WDF::quadraticPredictor,   true  },
+    { "predict-linearized", 0, 0, 0, false, WDF::linearizedPredictor,  true  },
+    { "linear-off",         0, 0, 0, false, WDF::holdPredictor,        false }
+};
+enum { numModes = sizeof (modes) / sizeof (modes[0]) };
+//------------------------------------------------------------------------------
+static void apply (StereoProcessor<double>& p, const Mode& m)
+{
+    const GovernorTier& g = governorTiers[m.tier];
+    p.setSolverQuality (g.tolerance, g.iterations, g.halvings);
+    p.setLinearTolerance (m.linear ? g.linear : 0.0);
+    p.setAntialiasing (m.antialiasing);
+    p.setClipAntialiasing (m.clipAntialiasing);
+    p.setDiodeBridge (m.diodeBridge);
+    p.setPredictor (m.predictor);
+}
+//==============================================================================
+// Reference renderer
+//==============================================================================
+class Reference
+{
+    public:
+        Reference (double sampleRate, int oversampling = 4, int timeConstant = 1,
+                   int block = 512)
+            : Fs (sampleRate), factor (jmax (1, oversampling)),
+              tc (timeConstant), blockSize (block)
+        {
+            //------------------------------------------------------------------
+            // Blackman windowed sinc, cutoff 0.45 Fs, (taps - 1) / 2 a
+            // multiple of the factor (integer delay at the base rate)
+            //------------------------------------------------------------------
+            taps = 64 * factor + 1;
+            h.allocate (taps, true);
+            const double fc = 0.45 / factor, m = taps - 1;
+            double sum = 0.0;
+            for (int j = 0; j < taps; ++j)
+            {
+                const double t = j - m/2;
+                const double sinc = (t == 0.0) ? 2.0*fc
+                                  : sin (2.0*double_Pi*fc*t) / (double_Pi*t);
+                const double w = 0.42 - 0.5*cos (2.0*double_Pi*j/m)
+                               + 0.08*cos (4.0*double_Pi*j/m);
+                h[j] = sinc * w; sum += h[j];
+            }
+            for (int j = 0; j < taps; ++j) h[j] /= sum;
+        }
+        //----------------------------------------------------------------------
+        // n output samples at the base rate
+        //----------------------------------------------------------------------
+        void render (const Stimulus& s, float* y, int n)
+        {
+            const int N = n * factor + taps; // the FIR looks ahead
+            HeapBlock<float> x (N), z (N);
+            synthesize (s, x, N, Fs * factor);
+            //------------------------------------------------------------------
+            StereoProcessor<double> p;
+            p.init (Fs * factor, blockSize);
+            p.parameters (tc, tc);
+            p.setSolverQuality (1e-12, 50, 12);
+            p.setLinearTolerance (0.0);
+            p.setQuietTolerance (0.0);
+            p.setAntialiasing (0);          // the oversampling antialiases
+            p.setClipAntialiasing (0);
+            Analysis::render (p, x, z, N, blockSize);
+            //------------------------------------------------------------------
+            const int delay = (taps - 1) / 2;
+            for (int i = 0; i < n; ++i)
+            {
+                double acc = 0.0;
+                const int c = i * factor + delay;
+                for (int j = 0; j < taps; ++j)
+                {
+                    const int k = c - j;
+                    if (k >= 0 && k < N) acc += h[j] * z[k];
+                }
+                y[i] = (float) acc;
+            }
+        }
+        //----------------------------------------------------------------------
+        double Fs;
+        int factor, tc, blockSize;
+        //----------------------------------------------------------------------
+    private:
+        HeapBlock<double> h;
+        int taps;
+};
+//==============================================================================
+// Golden files: <dir>/<stimulus>_<rate>.golden (magic, rate, n, floats)
+//==============================================================================
+enum { goldenMagic = 0x57363747 }; // "W67G"
+//------------------------------------------------------------------------------
+static File goldenFile (const File& dir, const Stimulus& s, double Fs)
+{
+    return dir.getChildFile (String (s.name) + "_" + String (roundToInt (Fs)) + ".golden");
+}
+//------------------------------------------------------------------------------
+static bool writeGolden (const File& f, double Fs, const float* y, int n)
+{
+    f.deleteFile ();
+    FileOutputStream out (f);
+    if (! out.openedOk ()) return false;
+    out.writeInt (goldenMagic); out.writeDouble (Fs); out.writeInt (n);
+    return out.write (y, n * sizeof (float));
+}
+//------------------------------------------------------------------------------
+static bool readGolden (const File& f, double Fs, float* y, int n)
+{
+    FileInputStream in (f);
+    if (! in.openedOk () || in.readInt () != goldenMagic) return false;
+    if (in.readDouble () != Fs || in.readInt () != n) return false;
+    return in.read (y, n * sizeof (float)) == (int) (n * sizeof (float));
+}
+//==============================================================================
+// y = x delayed by d samples (band limited: Blackman windowed sinc)
+//==============================================================================
+static void fractionalDelay (const float* x, float* y, int n, double d)
+{
+    const int half = 32;
+    const int shift = (int) floor (d);
+    const double frac = d - shift;
+    double h[2*half], sum = 0.0;
+    for (int j = 0; j < 2*half; ++j)
+    {
+        const double t = j - (half - 1) - frac, u = (j + 1 - frac) / (2*half);
+        const double sinc = (t == 0.0) ? 1.0 : sin (double_Pi*t) / (double_Pi*t);
+        h[j] = sinc * (0.42 - 0.5*cos (2.0*double_Pi*u) + 0.08*cos (4.0*double_Pi*u));
+        sum += h[j];
+    }
+    for (int j = 0; j < 2*half; ++j) h[j] /= sum;
+    for (int i = 0; i < n; ++i)
+    {
+        double acc = 0.0;
+        for (int j = 0; j < 2*half; ++j)
+        {
+            const int k = i - shift + (half - 1) - j;
+            if (k >= 0 && k < n) acc += h[j] * x[k];
+        }
+        y[i] = (float) acc;
+    }
+}
+//==============================================================================
+// Mode against reference
+//==============================================================================
+struct Result
+{
+    double residualDb;      // null test (dB below the reference)
+    double thdDelta;        // THD (mode) - THD (reference), tones only (%)
+    double grErrorDb;       // RMS gain-trace difference (dB)
+    double nsPerSample;
+    SolverStats solver;     // push/pull Newton solves of the rendering
+};
+//------------------------------------------------------------------------------
+static Result compare (const Mode& m, const Stimulus& s, const float* x,
+                       const float* reference, int n, double Fs, int tc = 1,
+                       int block = 512)
+{
+    HeapBlock<float> y (n);
+    StereoProcessor<double> p;
+    p.init (Fs, block); p.parameters (tc, tc); apply (p, m);
+    p.takeSolverStats ();                               // drop the warmup
+    Analysis::render (p, x, y, n, block);
+    //--------------------------------------------------------------------------
+    // the antialiased output clip delays the mode by order/2 samples
+    //--------------------------------------------------------------------------
+    HeapBlock<float> delayed;
+    if (m.clipAntialiasing > 0)
+    {
+        delayed.allocate (n, true);
+        fractionalDelay (reference, delayed, n, 0.5 * m.clipAntialiasing);
+        reference = delayed;
+    }
+    //--------------------------------------------------------------------------
+    Result r;
+    r.solver = p.takeSolverStats ();
+    r.residualDb = Analysis::nullDepth (reference, y, n);
+    r.grErrorDb = Analysis::gainTraceError (x, reference, y, n, (int) (0.01 * Fs));
+    r.thdDelta = 0.0;
+    if (s.kind == toneKind)
+    {
+        const int w = (int) (0.5 * Fs); // settled tail
+        r.thdDelta = 100.0 * (Analysis::harmonicDistortion (y + n - w, w, s.freq, Fs)
+                   - Analysis::harmonicDistortion (reference + n - w, w, s.freq, Fs));
+    }
+    //--------------------------------------------------------------------------
+    p.init (Fs, block); p.parameters (tc, tc); apply (p, m);
+    r.nsPerSample = Analysis::nanosecondsPerSample (p, x, n, block, 1);
+    return r;
+}
+//==============================================================================
+} // namespace Regression
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_REGRESSION_HPP_B5E8A14C__
+//==============================================================================
\ No newline at end of file
@@ -0,0 +1,440 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_SAMPLE_FORMAT_HPP_1F4B9D2E__
+#define __F670L_SAMPLE_FORMAT_HPP_1F4B9D2E__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+enum SampleFormat
+{
+    int16Format = 0,
+    int24Format,        // packed, 3 bytes little endian
+    int32Format,
+    float32Format,
+    float64Format
+};
+//------------------------------------------------------------------------------
+static inline int bytesPerSample (SampleFormat format)
+{
+    static const int size[] = { 2, 3, 4, 4, 8 };
+    return size[format];
+}
+//==============================================================================
+// Stereo I/O buffer: planar (one pointer per channel) or interleaved (both
+// channels behind data[0], left first)
+//==============================================================================
+struct SampleBuffer
+{
+    void* data[2];
+    SampleFormat format;
+    bool interleaved;
+    //--------------------------------------------------------------------------
+    static SampleBuffer planar (void* left, void* right, SampleFormat f)
+    {
+        SampleBuffer b = { { left, right }, f, false }; return b;
+    }
+    //--------------------------------------------------------------------------
+    static SampleBuffer interleave (void* frames, SampleFormat f)
+    {
+        SampleBuffer b = { { frames, frames }, f, true }; return b;
+    }
+};
+//==============================================================================
+// Codecs: one sample at 'index' (in samples) <-> [-1, 1], and runs of n
+// contiguous samples (the block loops, quantized without branches or calls)
+//==============================================================================
+namespace Codec {
+//------------------------------------------------------------------------------
+// scale, clamp to [-top, top - 1] and round half up, without a branch: the
+// value is biased into the positive range, clamped with min/max and
+// truncated, then unbiased (roundToInt and sign selects do not vectorize)
+//------------------------------------------------------------------------------
+template <typename T>
+static inline int32 quantize (T x, T scale, T top)
+{
+    const T y = jmin (jmax (x * scale + top + T (0.5), T (0.0)), T (2.0) * top - T (0.5));
+    return (int32) y - (int32) top;
+}
+//------------------------------------------------------------------------------
+struct Int16
+{
+    template <typename T> static inline T load (const void* p, int index)
+    {
+        return T (((const int16*) p)[index]) * T (1.0 / 32768.0);
+    }
+    template <typename T> static inline void store (void* p, int index, T x)
+    {
+        ((int16*) p)[index] = (int16) quantize (x, T (32768.0), T (32768.0));
+    }
+    template <typename T> static inline void loadRun (const void* p, int index, T* x, int n)
+    {
+        const int16* s = (const int16*) p + index;
+        for (int i = 0; i < n; ++i) x[i] = T (s[i]) * T (1.0 / 32768.0);
+    }
+    template <typename T> static inline void storeRun (void* p, int index, const T* x, int n)
+    {
+        int16* d = (int16*) p + index;
+        for (int i = 0; i < n; ++i)
+            d[i] = (int16) quantize (x[i], T (32768.0), T (32768.0));
+    }
+};
+//------------------------------------------------------------------------------
+struct Int24
+{
+    template <typename T> static inline T load (const void* p, int index)
+    {
+        const uint8* s = (const uint8*) p + 3*index;
+        const int32 v = (int32) ((uint32) s[0] << 8 | (uint32) s[1] << 16
+                                                    | (uint32) s[2] << 24) >> 8;
+        return T (v) * T (1.0 / 8388608.0);
+    }
+    template <typename T> static inline void store (void* p, int index, T x)
+    {
+        const int32 v = quantize (x, T (8388608.0), T (8388608.0));
+        uint8* d = (uint8*) p + 3*index;
+        d[0] = (uint8) v; d[1] = (uint8) (v >> 8); d[2] = (uint8) (v >> 16);
+    }
+    template <typename T> static inline void loadRun (const void* p, int index, T* x, int n)
+    {
+        for (int i = 0; i < n; ++i) x[i] = load<T> (p, index + i);
+    }
+    //--------------------------------------------------------------------------
+    // quantized in a vectorizable pass, then packed 4 samples per 3 words
+    //--------------------------------------------------------------------------
+    template <typename T> static inline void storeRun (void* p, int index, const T* x, int n)
+    {
+        enum { chunk = 256 };
+        uint32 v[chunk];
+        uint8* d = (uint8*) p + 3*index;
+        for (int done = 0; done < n; done += chunk)
+        {
+            const int m = jmin ((int) chunk, n - done);
+            int i = 0;
+            for (; i < m; ++i)
+                v[i] = (uint32) quantize (x[done + i], T (8388608.0), T (8388608.0)) & 0xffffff;
+            for (i = 0; i + 4 <= m; i += 4, d += 12)
+            {
+                const uint32 w[3] = {
+                    ByteOrder::swapIfBigEndian (v[i]           | v[i + 1] << 24),
+                    ByteOrder::swapIfBigEndian (v[i + 1] >> 8  | v[i + 2] << 16),
+                    ByteOrder::swapIfBigEndian (v[i + 2] >> 16 | v[i + 3] << 8) };
+                memcpy (d, w, 12);
+            }
+            for (; i < m; ++i, d += 3)
+            {
+                d[0] = (uint8) v[i]; d[1] = (uint8) (v[i] >> 8); d[2] = (uint8) (v[i] >> 16);
+            }
+        }
+    }
+};
+//------------------------------------------------------------------------------
+struct Int32
+{
+    template <typename T> static inline T load (const void* p, int index)
+    {
+        return T (((const int32*) p)[index]) * T (1.0 / 2147483648.0);
+    }
+    //--------------------------------------------------------------------------
+    // as quantize(), in double and through int64 (2^32 does not fit int32,
+    // 2^31 - 1 is not a float)
+    //--------------------------------------------------------------------------
+    static inline int32 quantize32 (double x)
+    {
+        const double y = jmin (jmax (x * 2147483648.0 + 2147483648.5, 0.0), 4294967295.5);
+        return (int32) ((int64) y - (int64) 2147483648LL);
+    }
+    template <typename T> static inline void store (void* p, int index, T x)
+    {
+        ((int32*) p)[index] = quantize32 (double (x));
+    }
+    template <typename T> static inline void loadRun (const void* p, int index, T* x, int n)
+    {
+        const int32* s = (const int32*) p + index;
+        for (int i = 0; i < n; ++i) x[i] = T (s[i]) * T (1.0 / 2147483648.0);
+    }
+    template <typename T> static inline void storeRun (void* p, int index, const T* x, int n)
+    {
+        int32* d = (int32*) p + index;
+        for (int i = 0; i < n; ++i) d[i] = quantize32 (double (x[i]));
+    }
+};
+//------------------------------------------------------------------------------
+struct Float32
+{
+    template <typename T> static inline T load (const void* p, int index)
+    {
+        return T (((const float*) p)[index]);
+    }
+    template <typename T> static inline void store (void* p, int index, T x)
+    {
+        ((float*) p)[index] = (float) x;
+    }
+    template <typename T> static inline void loadRun (const void* p, int index, T* x, int n)
+    {
+        const float* s = (const float*) p + index;
+        for (int i = 0; i < n; ++i) x[i] = T (s[i]);
+    }
+    template <typename T> static inline void storeRun (void* p, int index, const T* x, int n)
+    {
+        float* d = (float*) p + index;
+        for (int i = 0; i < n; ++i) d[i] = (float) x[i];
+    }
+};
+//------------------------------------------------------------------------------
+struct Float64
+{
+    template <typename T> static inline T load (const void* p, int index)
+    {
+        return T (((const double*) p)[index]);
+    }
+    template <typename T> static inline void store (void* p, int index, T x)
+    {
+        ((double*) p)[index] = (double) x;
+    }
+    template <typename T> static inline void loadRun (const void* p, int index, T* x, int n)
+    {
+        const double* s = (const double*) p + index;
+        for (int i = 0; i < n; ++i) x[i] = T (s[i]);
+    }
+    template <typename T> static inline void storeRun (void* p, int index, const T* x, int n)
+    {
+        double* d = (double*) p + index;
+        for (int i = 0; i < n; ++i) d[i] = (double) x[i];
+    }
+};
+//------------------------------------------------------------------------------
+} // namespace Codec
+//==============================================================================
+// Fused conversions: format + input matrix + level in, and output matrix +
+// gain + clip + format out. The layout (planar or interleaved) is a template
+// parameter, so every stride is a compile-time constant, and the mid/side
+// choice is hoisted out of the sample loops: each loop is a straight,
+// vectorizable pass. Interleaved frames go through a stack chunk so the
+// codec always sees contiguous runs.
+//==============================================================================
+namespace Conversion {
+//------------------------------------------------------------------------------
+enum { chunk = 256 };   // frames per pass through the stack scratch
+//------------------------------------------------------------------------------
+template <int Stride, typename T>
+static inline void matrixIn (const T* l, const T* r, T* a, T* b, int n,
+                             T levelA, T levelB, bool midside)
+{
+    int i = 0;
+    if (midside)
+    {
+        const T ka = levelA * T (0.70710678118654752440);
+        const T kb = levelB * T (0.70710678118654752440);
+        for (; i < n; ++i)
+        {
+            const T x = l[Stride*i], y = r[Stride*i];
+            a[i] = (x + y) * ka;
+            b[i] = (x - y) * kb;
+        }
+    }
+    else
+    {
+        for (; i < n; ++i)
+        {
+            const T x = l[Stride*i], y = r[Stride*i];
+            a[i] = x * levelA;
+            b[i] = y * levelB;
+        }
+    }
+}
+//------------------------------------------------------------------------------
+template <int Stride, typename T>
+static inline void matrixOut (const T* a, const T* b, T* l, T* r, int n,
+                              T gain, bool midside, bool clip)
+{
+    const T k  = midside ? gain * T (0.70710678118654752440) : gain;
+    const T lo = clip ? T (-1.0) : T (-1e30);
+    const T hi = clip ? T ( 1.0) : T ( 1e30);
+    int i = 0;
+    if (midside)
+    {
+        for (; i < n; ++i)
+        {
+            l[Stride*i] = jmin (jmax ((a[i] + b[i]) * k, lo), hi);
+            r[Stride*i] = jmin (jmax ((a[i] - b[i]) * k, lo), hi);
+        }
+    }
+    else
+    {
+        for (; i < n; ++i)
+        {
+            l[Stride*i] = jmin (jmax (a[i] * k, lo), hi);
+            r[Stride*i] = jmin (jmax (b[i] * k, lo), hi);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+template <typename C, bool Interleaved, typename T>
+static void readStereo (const SampleBuffer& in, int offset, T* a, T* b, int n,
+                        T levelA, T levelB, bool midside)
+{
+    if (! Interleaved)
+    {
+        C::loadRun (in.data[0], offset, a, n);
+        C::loadRun (in.data[1], offset, b, n);
+        matrixIn<1> (a, b, a, b, n, levelA, levelB, midside);
+        return;
+    }
+    T x[2*chunk];
+    for (int done = 0; done < n; done += chunk)
+    {
+        const int m = jmin ((int) chunk, n - done);
+        C::loadRun (in.data[0], 2*(offset + done), x, 2*m);
+        matrixIn<2> (x, x + 1, a + done, b + done, m, levelA, levelB, midside);
+    }
+}
+//------------------------------------------------------------------------------
+template <typename C, bool Interleaved, typename T>
+static void writeStereo (const T* a, const T* b, const SampleBuffer& out,
+                         int offset, int n, T gain, bool midside, bool clip)
+{
+    T x[2*chunk];
+    for (int done = 0; done < n; done += chunk)
+    {
+        const int m = jmin ((int) chunk, n - done);
+        if (Interleaved)
+        {
+            matrixOut<2> (a + done, b + done, x, x + 1, m, gain, midside, clip);
+            C::storeRun (out.data[0], 2*(offset + done), x, 2*m);
+        }
+        else
+        {
+            matrixOut<1> (a + done, b + done, x, x + chunk, m, gain, midside, clip);
+            C::storeRun (out.data[0], offset + done, x, m);
+            C::storeRun (out.data[1], offset + done, x + chunk, m);
+        }
+    }
+}
+//------------------------------------------------------------------------------
+template <typename C, typename T>
+static inline void readLayout (const SampleBuffer& in, int offset, T* a, T* b,
+                               int n, T levelA, T levelB, bool midside)
+{
+    if (in.interleaved) readStereo<C, true>  (in, offset, a, b, n, levelA, levelB, midside);
+    else                readStereo<C, false> (in, offset, a, b, n, levelA, levelB, midside);
+}
+//------------------------------------------------------------------------------
+template <typename C, typename T>
+static inline void writeLayout (const T* a, const T* b, const SampleBuffer& out,
+                                int offset, int n, T gain, bool midside, bool clip)
+{
+    if (out.interleaved) writeStereo<C, true>  (a, b, out, offset, n, gain, midside, clip);
+    else                 writeStereo<C, false> (a, b, out, offset, n, gain, midside, clip);
+}
+//------------------------------------------------------------------------------
+template <typename T>
+static void read (const SampleBuffer& in, int offset, T* a, T* b, int n,
+                  T levelA, T levelB, bool midside)
+{
+    switch (in.format)
+    {
+        case int16Format:   readLayout<Codec::Int16>   (in, offset, a, b, n, levelA, levelB, midside); break;
+        case int24Format:   readLayout<Codec::Int24>   (in, offset, a, b, n, levelA, levelB, midside); break;
+        case int32Format:   readLayout<Codec::Int32>   (in, offset, a, b, n, levelA, levelB, midside); break;
+        case float32Format: readLayout<Codec::Float32> (in, offset, a, b, n, levelA, levelB, midside); break;
+        case float64Format: readLayout<Codec::Float64> (in, offset, a, b, n, levelA, levelB, midside); break;
+        default: jassertfalse; break;
+    };
+}
+//------------------------------------------------------------------------------
+// clip: the plain [-1, 1] hard clip (the output clip at antialiasing order 0)
+//------------------------------------------------------------------------------
+template <typename T>
+static void write (const T* a, const T* b, const SampleBuffer& out, int offset,
+                   int n, T gain, bool midside, bool clip)
+{
+    switch (out.format)
+    {
+        case int16Format:   writeLayout<Codec::Int16>   (a, b, out, offset, n, gain, midside, clip); break;
+        case int24Format:   writeLayout<Codec::Int24>   (a, b, out, offset, n, gain, midside, clip); break;
+        case int32Format:   writeLayout<Codec::Int32>   (a, b, out, offset, n, gain, midside, clip); break;
+        case float32Format: writeLayout<Codec::Float32> (a, b, out, offset, n, gain, midside, clip); break;
+        case float64Format: writeLayout<Codec::Float64> (a, b, out, offset, n, gain, midside, clip); break;
+        default: jassertfalse; break;
+    };
+}
+//------------------------------------------------------------------------------
+// plain mono conversion (one channel of a buffer, unity gain)
+//------------------------------------------------------------------------------
+template <typename C, typename T>
+static void readMono (const void* src, int n, T* dst)
+{
+    C::loadRun (src, 0, dst, n);
+}
+//------------------------------------------------------------------------------
+template <typename C, typename T>
+static void writeMono (const T* src, int n, void* dst)
+{
+    C::storeRun (dst, 0, src, n);
+}
+//------------------------------------------------------------------------------
+template <typename T>
+static void toNative (const void* src, SampleFormat format, T* dst, int n)
+{
+    switch (format)
+    {
+        case int16Format:   readMono<Codec::Int16>   (src, n, dst); break;
+        case int24Format:   readMono<Codec::Int24>   (src, n, dst); break;
+        case int32Format:   readMono<Codec::Int32>   (src, n, dst); break;
+        case float32Format: readMono<Codec::Float32> (src, n, dst); break;
+        case float64Format: readMono<Codec::Float64> (src, n, dst); break;
+        default: jassertfalse; break;
+    };
+}
+//------------------------------------------------------------------------------
+template <typename T>
+static void fromNative (const T* src, void* dst, SampleFormat format, int n)
+{
+    switch (format)
+    {
+        case int16Format:   writeMono<Codec::Int16>   (src, n, dst); break;
+        case int24Format:   writeMono<Codec::Int24>   (src, n, dst); break;
+        case int32Format:   writeMono<Codec::Int32>   (src, n, dst); break;
+        case float32Format: writeMono<Codec::Float32> (src, n, dst); break;
+        case float64Format: writeMono<Codec::Float64> (src, n, dst); break;
+        default: jassertfalse; break;
+    };
+}
+//------------------------------------------------------------------------------
+} // namespace Conversion
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_SAMPLE_FORMAT_HPP_1F4B9D2E__
+//==============================================================================
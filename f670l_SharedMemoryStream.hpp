@@ -0,0 +1,504 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_SHARED_MEMORY_STREAM_HPP_5A866D54__
+#define __F670L_SHARED_MEMORY_STREAM_HPP_5A866D54__
+//==============================================================================
+#include "f670l_StereoProcessor.hpp"
+#include "f670l_SampleFormat.hpp"
+//------------------------------------------------------------------------------
+#if JUCE_LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+//==============================================================================
+namespace Wavechild670 {
+namespace Stream {
+//==============================================================================
+//
+//                    SHARED MEMORY STREAM LAYOUT
+//                    ---------------------------
+//
+//      [ Header (4 kB) ][ plane 0 : capacity frames ][ plane 1 : ... ]
+//
+//      Three free-running frame counters drive the ring:
+//
+//          consumed  <=  processed  <=  written
+//
+//      the producer writes frames at 'written', the daemon processes
+//      [processed, written) in place, the consumer reads up to 'processed'.
+//      Each side sleeps on the counter it waits for (futex, process-shared)
+//      and wakes the other side after advancing its own.
+//
+//      The header also carries, per stream:
+//
+//      - write stamps: the producer stamps the end frame and time of every
+//        block it writes (stampWrite), the daemon measures each block's
+//        latency when it has processed the block's last frame
+//      - a parameter channel: any process sets limiter parameters
+//        (setParameter, index and value as applyParameter), the daemon
+//        applies them between blocks
+//
+//==============================================================================
+// Frames are planar, in float32Format, int24Format or int16Format
+//------------------------------------------------------------------------------
+static inline int64 nanoseconds ()
+{
+    timespec ts; clock_gettime (CLOCK_MONOTONIC, &ts);
+    return int64 (ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+//==============================================================================
+struct LatencyStats // daemon, per block: write to processed (see readLatency)
+{
+    int64 count;
+    double last, min, max, mean; // seconds
+};
+//------------------------------------------------------------------------------
+struct Header
+{
+    enum { magicNumber = 0x57433637, currentVersion = 3, size = 4096 };
+    enum { numStamps = 64, maxParameters = 32 };
+    //--------------------------------------------------------------------------
+    uint32 magic, version;
+    int32 format, numChannels, capacity; // SampleFormat, frames (power of two)
+    double sampleRate;
+    //--------------------------------------------------------------------------
+    // frame counters, free running: differences in uint32 arithmetic
+    //--------------------------------------------------------------------------
+    Atomic<uint32> written, processed, consumed;
+    Atomic<int> closed;
+    //--------------------------------------------------------------------------
+    // write stamps: stamp k in stamps[k % numStamps], stampCount stamps
+    // written (the producer fills a stamp, then counts it)
+    //--------------------------------------------------------------------------
+    struct Stamp
+    {
+        Atomic<uint32> frame;   // 'written' after the block
+        Atomic<int64> time;     // ns, CLOCK_MONOTONIC
+    };
+    Stamp stamps[numStamps];
+    Atomic<uint32> stampCount;
+    //--------------------------------------------------------------------------
+    // parameter channel: values, then a bit per changed parameter
+    //--------------------------------------------------------------------------
+    Atomic<float> parameters[maxParameters];
+    Atomic<uint32> parameterChanged;
+    //--------------------------------------------------------------------------
+    Atomic<uint32> latencySequence; // seqlock: odd while the daemon writes
+    LatencyStats latency;
+};
+//------------------------------------------------------------------------------
+static_assert (sizeof (Header) <= Header::size, "header does not fit its page");
+static_assert (numParameters <= Header::maxParameters, "parameter channel too small");
+//==============================================================================
+static inline void futexWait (Atomic<uint32>& word, uint32 expected, int timeoutMs)
+{
+    timespec ts; ts.tv_sec = timeoutMs / 1000;
+                 ts.tv_nsec = (timeoutMs % 1000) * 1000000;
+    syscall (SYS_futex, &word.value, FUTEX_WAIT, (int) expected, &ts, nullptr, 0);
+}
+//------------------------------------------------------------------------------
+static inline void futexWake (Atomic<uint32>& word)
+{
+    syscall (SYS_futex, &word.value, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+//==============================================================================
+// Latency statistics, published by the daemon through a seqlock (as Meter)
+//==============================================================================
+static inline void publishLatency (Header& h, const LatencyStats& s)
+{
+    h.latencySequence += 1;                 // odd: write in progress
+    h.latency = s;
+    h.latencySequence += 1;                 // even: stable
+}
+//------------------------------------------------------------------------------
+// any process: false when no stable copy was read in a few tries
+//------------------------------------------------------------------------------
+static inline bool readLatency (const Header& h, LatencyStats& s, int tries = 16)
+{
+    for (int k = 0; k < tries; ++k)
+    {
+        const uint32 s0 = h.latencySequence.get ();
+        if (s0 & 1) continue;
+        memcpy (&s, (const void*) &h.latency, sizeof (s));
+        Atomic<int>::memoryBarrier ();
+        if (h.latencySequence.get () == s0) return true;
+    }
+    return false;
+}
+//==============================================================================
+// Producer side: after advancing 'written', one stamp per block
+//==============================================================================
+static inline void stampWrite (Header& h, uint32 written)
+{
+    const uint32 k = h.stampCount.get ();
+    Header::Stamp& s = h.stamps[k % Header::numStamps];
+    s.frame = written;
+    s.time = nanoseconds ();
+    h.stampCount = k + 1;
+}
+//==============================================================================
+// Parameter channel: any process, several writers (the last value wins)
+//==============================================================================
+static inline void setParameter (Header& h, int index, float value)
+{
+    if (! isPositiveAndBelow (index, (int) numParameters)) return;
+    h.parameters[index] = value;
+    for (;;)
+    {
+        const uint32 bits = h.parameterChanged.get ();
+        if (h.parameterChanged.compareAndSetBool (bits | (1u << index), bits)) return;
+    }
+}
+//==============================================================================
+// Shared ring mapping (POSIX shared memory object)
+//==============================================================================
+class SharedRing
+{
+    public:
+        SharedRing () : header (nullptr), size (0), owner (false) {}
+        ~SharedRing () { close (); }
+        //----------------------------------------------------------------------
+        bool create (const String& ringName, SampleFormat format, int numChannels,
+                     int capacity, double sampleRate)
+        {
+            jassert (isPowerOfTwo (capacity));
+            close ();
+            name = ringName; owner = true;
+            size = Header::size + (size_t) numChannels * capacity
+                                                * bytesPerSample (format);
+            //------------------------------------------------------------------
+            int fd = shm_open (name.toRawUTF8(), O_CREAT | O_RDWR, 0660);
+            if (fd < 0) return false;
+            if (ftruncate (fd, (off_t) size) != 0) { ::close (fd); return false; }
+            if (! map (fd)) return false;
+            //------------------------------------------------------------------
+            zeromem (header, size);
+            header->magic = Header::magicNumber;
+            header->version = Header::currentVersion;
+            header->format = format;
+            header->numChannels = numChannels;
+            header->capacity = capacity;
+            header->sampleRate = sampleRate;
+            return true;
+        }
+        //----------------------------------------------------------------------
+        bool open (const String& ringName)
+        {
+            close ();
+            name = ringName; owner = false;
+            //------------------------------------------------------------------
+            int fd = shm_open (name.toRawUTF8(), O_RDWR, 0660);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat (fd, &st) != 0) { ::close (fd); return false; }
+            size = (size_t) st.st_size;
+            if (! map (fd)) return false;
+            //------------------------------------------------------------------
+            if (header->magic != Header::magicNumber
+             || header->version != Header::currentVersion) { close (); return false; }
+            return true;
+        }
+        //----------------------------------------------------------------------
+        void close ()
+        {
+            if (header != nullptr)
+            {
+                if (owner) { header->closed = 1; futexWake (header->written);
+                                                 futexWake (header->processed); }
+                munmap (header, size);
+                if (owner) shm_unlink (name.toRawUTF8());
+            }
+            header = nullptr;
+        }
+        //----------------------------------------------------------------------
+        Header* getHeader () const { return header; }
+        //----------------------------------------------------------------------
+        char* plane (int channel) const
+        {
+            return (char*) header + Header::size
+                 + (size_t) channel * header->capacity
+                           * bytesPerSample ((SampleFormat) header->format);
+        }
+        //----------------------------------------------------------------------
+    private:
+        Header* header;
+        size_t size;
+        String name;
+        bool owner;
+        //----------------------------------------------------------------------
+        bool map (int fd)
+        {
+            void* p = mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close (fd);
+            if (p == MAP_FAILED) return false;
+            header = (Header*) p;
+            return true;
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (SharedRing)
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// One stream served by the daemon: a ring, a limiter and a worker thread
+//==============================================================================
+template <typename T>
+class StreamWorker : public Thread
+{
+    public:
+        StreamWorker (const String& name, SampleFormat format, int capacity,
+                      double sampleRate, int blockSize)
+            : Thread ("Wavechild670 stream " + name),
+              maxBlock (jmin (blockSize, capacity)), stampRead (0)
+        {
+            zerostruct (stats);
+            stats.min = 1e9;
+            ok = ring.create (name, format, 2, capacity, sampleRate);
+            if (ok) publishLatency (*ring.getHeader(), stats);
+            processor.init (sampleRate, maxBlock);
+        }
+        //----------------------------------------------------------------------
+        ~StreamWorker ()
+        {
+            signalThreadShouldExit ();
+            if (ok) futexWake (ring.getHeader()->written);
+            stopThread (1000);
+        }
+        //----------------------------------------------------------------------
+        bool isValid () const { return ok; }
+        StereoProcessor<T>& getProcessor () { return processor; }
+        LatencyStats getLatency () const
+        {
+            LatencyStats s = stats;     // the last published, if torn
+            readLatency (*ring.getHeader(), s);
+            return s;
+        }
+        //----------------------------------------------------------------------
+        void run ()
+        {
+            Header& h = *ring.getHeader();
+            const uint32 mask = (uint32) h.capacity - 1;
+            //------------------------------------------------------------------
+            stampRead = h.stampCount.get ();
+            while (! threadShouldExit ())
+            {
+                const uint32 written = h.written.get();
+                uint32 processed = h.processed.get();
+                if (written == processed) { futexWait (h.written, written, 100);
+                                            continue; }
+                //--------------------------------------------------------------
+                while (processed != written)
+                {
+                    applyParameters (h);
+                    const int pos = (int) (processed & mask);
+                    const int n = jmin ((int) (written - processed),
+                                        h.capacity - pos, maxBlock);
+                    process ((SampleFormat) h.format, pos, n);
+                    processed += n;
+                    h.processed = processed;
+                    measure (h, processed);
+                }
+                futexWake (h.processed);
+            }
+        }
+        //----------------------------------------------------------------------
+    private:
+        SharedRing ring;
+        StereoProcessor<T> processor;
+        LatencyStats stats;         // this thread, published to the header
+        const int maxBlock;
+        uint32 stampRead;           // next write stamp to measure
+        bool ok;
+        //----------------------------------------------------------------------
+        void process (SampleFormat format, int pos, int n)
+        {
+            const int bps = bytesPerSample (format);
+            const SampleBuffer io = SampleBuffer::planar (ring.plane (0) + pos*bps,
+                                                          ring.plane (1) + pos*bps,
+                                                          format);
+            processor.processBlock (io, io, n); // in place, any format
+        }
+        //----------------------------------------------------------------------
+        void applyParameters (Header& h)
+        {
+            const uint32 bits = h.parameterChanged.exchange (0);
+            for (int i = 0; bits != 0 && i < numParameters; ++i)
+                if (bits & (1u << i))
+                    applyParameter (processor, i, h.parameters[i].get ());
+        }
+        //----------------------------------------------------------------------
+        // every block whose last frame is processed: a stamp is read, then
+        // dropped if the producer started to overwrite it meanwhile (the
+        // daemon fell numStamps blocks behind: those blocks are skipped)
+        //----------------------------------------------------------------------
+        void measure (Header& h, uint32 processed)
+        {
+            LatencyStats& s = stats;
+            const int64 now = nanoseconds ();
+            bool changed = false;
+            for (;;)
+            {
+                const uint32 count = h.stampCount.get ();
+                if (count - stampRead > (uint32) Header::numStamps - 1)
+                    stampRead = count - (Header::numStamps - 1);
+                if (stampRead == count) break;
+                //--------------------------------------------------------------
+                const Header::Stamp& stamp = h.stamps[stampRead % Header::numStamps];
+                const uint32 frame = stamp.frame.get ();
+                const int64 time = stamp.time.get ();
+                if (h.stampCount.get () - stampRead > (uint32) Header::numStamps - 1)
+                    continue;                           // overwritten
+                if ((int32) (processed - frame) < 0) break; // not processed yet
+                ++stampRead;
+                //--------------------------------------------------------------
+                const double t = (now - time) * 1e-9;
+                s.last = t;
+                s.min = jmin (s.min, t);
+                s.max = jmax (s.max, t);
+                s.mean += (t - s.mean) / (double) (++s.count);
+                changed = true;
+            }
+            if (changed) publishLatency (h, s);
+        }
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (StreamWorker)
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// Test client: drives a stream with synthetic audio (producer + consumer),
+// switching both time constants halfway through the parameter channel
+//==============================================================================
+class TestClient
+{
+    public:
+        struct Result
+        {
+            int64 frames;
+            double outputPeak;
+            bool finite;
+            LatencyStats latency;
+        };
+        //----------------------------------------------------------------------
+        static bool run (const String& name, double seconds, int blockSize,
+                         Result& result)
+        {
+            SharedRing ring;
+            if (! ring.open (name)) return false;
+            Header& h = *ring.getHeader();
+            //------------------------------------------------------------------
+            const uint32 mask = (uint32) h.capacity - 1;
+            const SampleFormat format = (SampleFormat) h.format;
+            const int bps = bytesPerSample (format);
+            const int64 total = (int64) (seconds * h.sampleRate);
+            HeapBlock<float> buf (blockSize);
+            //------------------------------------------------------------------
+            result.frames = 0; result.outputPeak = 0.0; result.finite = true;
+            int64 generated = 0;
+            uint32 written = h.written.get(), consumed = h.consumed.get();
+            //------------------------------------------------------------------
+            while (result.frames < total && h.closed.get() == 0)
+            {
+                //--------------------------------------------------------------
+                // produce: a 1 kHz tone with a slow 40 dB level ramp, so the
+                // limiter goes through attack and release, each block stamped
+                //--------------------------------------------------------------
+                const int used = (int) (written - consumed);
+                const int n = (int) jmin ((int64) (h.capacity - used),
+                                          (int64) (h.capacity - (int) (written & mask)),
+                                          (int64) blockSize, total - generated);
+                if (n > 0)
+                {
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const double t = (generated + i) / h.sampleRate;
+                        const double level = pow (10.0, (-40.0 + 40.0 * fmod (t, 2.0) / 2.0) / 20.0);
+                        buf[i] = (float) (level * sin (2.0 * double_Pi * 1000.0 * t));
+                    }
+                    for (int c = 0; c < h.numChannels; ++c)
+                    {
+                        char* dst = ring.plane (c) + (written & mask) * bps;
+                        Conversion::fromNative<float> (buf, dst, format, n);
+                    }
+                    //----------------------------------------------------------
+                    // halfway, through the parameter channel: the slowest
+                    // time constant on both sides
+                    //----------------------------------------------------------
+                    if (generated < total / 2 && generated + n >= total / 2)
+                    {
+                        setParameter (h, 2, 0.5f);
+                        setParameter (h, 5, 0.5f);
+                    }
+                    generated += n; written += n;
+                    stampWrite (h, written); // before the frames are visible
+                    h.written = written;
+                    futexWake (h.written);
+                }
+                //--------------------------------------------------------------
+                // consume what the daemon processed
+                //--------------------------------------------------------------
+                const uint32 processed = h.processed.get();
+                if (processed == consumed) { futexWait (h.processed, processed, 100);
+                                             continue; }
+                while (consumed != processed)
+                {
+                    const int pos = (int) (consumed & mask);
+                    const int m = jmin ((int) (processed - consumed),
+                                        h.capacity - pos, blockSize);
+                    for (int c = 0; c < h.numChannels; ++c)
+                    {
+                        const char* src = ring.plane (c) + pos * bps;
+                        Conversion::toNative<float> (src, format, buf, m);
+                        for (int i = 0; i < m; ++i)
+                        {
+                            result.finite &= (buf[i] == buf[i]);
+                            result.outputPeak = jmax (result.outputPeak,
+                                                      (double) std::abs (buf[i]));
+                        }
+                    }
+                    consumed += m; result.frames += m;
+                }
+                h.consumed = consumed;
+            }
+            readLatency (h, result.latency);
+            return result.frames >= total;
+        }
+};
+//==============================================================================
+} // namespace Stream
+} // namespace Wavechild670
+//==============================================================================
+#endif  // JUCE_LINUX
+#endif  // __F670L_SHARED_MEMORY_STREAM_HPP_5A866D54__
+//==============================================================================
@@ -44,51 +44,197 @@ class SidechainAmplifier
 {
     public:
         SidechainAmplifier (T Fs)
-            : AC (0.5), DC (0.1)
-        {}
+            : AC (0.5), DC (0.1),
+              //----------------------------------------------------------------
+              // memoryless stages (antialiasing off until setAntialiasing)
+              //----------------------------------------------------------------
+              threshold (Threshold (WDF::Softplus<T> (-6.0,  1.0, -0.1),
+                                    WDF::Softplus<T> ( 6.0, -1.0, -0.1)), 0),
+              drive     (WDF::HardClip<T> (-100.0, 100.0, 8.4), 0),
+              bridge    (WDF::Softplus<T> (0.000375 * 0.0125, 10.0 / 0.6, -10.0), 0),
+              limiter   (WDF::Softplus<T> (-0.05, 10.0 / 0.5, -10.0, 1.0), 0),
+              //----------------------------------------------------------------
+              rectifier (12.8e3, 2.52e-9, 25.85e-3, 1.752, 2, "Bridge"),
+              diodeBridge (false),
+              //----------------------------------------------------------------
+              quietTolerance (1e-9), skipping (false), lastPot (0.0), lastCap (0.0)
+        {
+            transformer.prepareBlock ();
+            refreshQuiet ();
+        }
         //----------------------------------------------------------------------
         void parameters (T ACThreshold, T DCThreshold)
         {
             DC = 12.2 * (DCThreshold + 0.1);
             AC = 0.5 * ACThreshold * ACThreshold;
+            //------------------------------------------------------------------
+            threshold.f.a.c = threshold.f.b.c = -DC;
+            threshold.refresh ();
+            refreshQuiet ();
+        }
+        //----------------------------------------------------------------------
+        // below-threshold early-out: the chain is skipped while its bridge
+        // current is provably under tolerance (amps, 0 = always run it)
+        //----------------------------------------------------------------------
+        void setQuietTolerance (T amps)
+        {
+            quietTolerance = jmax ((T) 0.0, amps);
+            refreshQuiet ();
+        }
+        //----------------------------------------------------------------------
+        // antiderivative antialiasing order (0 = off, 1 or 2)
+        //----------------------------------------------------------------------
+        void setAntialiasing (int order)
+        {
+            threshold.setOrder (order);
+            drive.setOrder (order);
+            bridge.setOrder (order);
+            limiter.setOrder (order);
+        }
+        //----------------------------------------------------------------------
+        // bridge rectifier: softplus approximation (default, antialiasable) or
+        // the conducting diode pair of the bridge solved explicitly at the
+        // root (Wright omega, fixed cost, not antialiased)
+        //----------------------------------------------------------------------
+        void setDiodeBridge (bool diodes) { diodeBridge = diodes; }
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
+        {
+            transformer.state (s);
+            threshold.state (s); drive.state (s);
+            bridge.state (s);    limiter.state (s);
+            skipping = false;
         }
         //----------------------------------------------------------------------
         // Fairchild 670 Class-B Sidechain Amplifier model
-	//----------------------------------------------------------------------
+        //----------------------------------------------------------------------
         virtual inline T process (T Vsc, T VlevelCap)
         {
-	    //------------------------------------------------------------------
-	    // AC Threshold Input Transformer
-	    //------------------------------------------------------------------
-            Vpot = AC * transformer.process (Vsc);
-	    //------------------------------------------------------------------
+            return detect (pot (Vsc), VlevelCap);
+        }
+        //----------------------------------------------------------------------
+        // AC Threshold Input Transformer (linear): per sample, or over a
+        // block (returns the peak of |Vpot|)
+        //----------------------------------------------------------------------
+        inline T pot (T Vsc) { return AC * transformer.process (Vsc); }
+        //----------------------------------------------------------------------
+        inline T potBlock (const T* Vsc, T* pots, int numSamples)
+        {
+            transformer.processBlock (Vsc, pots, numSamples);
+            T peak = 0.0;
+            for (int i = 0; i < numSamples; ++i)
+            {
+                pots[i] *= AC;
+                peak = jmax (peak, (T) fabs (pots[i]));
+            }
+            return peak;
+        }
+        //----------------------------------------------------------------------
+        // Below threshold: for |Vpot| <= peak, the level cap voltage at or
+        // above which the bridge current stays under tolerance. Conservative
+        // bound of the chain: |Vs1| <= 12.|Vpot|.sigmoid (|Vpot| - DC) (both
+        // softplus are 1-Lipschitz with slope sigmoid), |drive| <= 8.4.|Vs1|,
+        // bridge <= s.exp (k.Vdiff + c).
+        //----------------------------------------------------------------------
+        inline T quietFloor (T peak) const
+        {
+            if (quietTolerance <= 0.0 || diodeBridge || peak > quietPot) return 1e30;
+            return peak * quietGain - quietDiff;
+        }
+        //----------------------------------------------------------------------
+        // the bridge current is negligible: the limiter output is its
+        // constant at zero, the nonlinear stages are left as they are
+        //----------------------------------------------------------------------
+        inline T skip (T Vp, T VlevelCap)
+        {
+            skipping = true; lastPot = Vp; lastCap = VlevelCap;
+            return quietCurrent;
+        }
+        //----------------------------------------------------------------------
+        inline T detect (T Vp, T VlevelCap)
+        {
+            if (VlevelCap >= quietFloor (fabs (Vp))) return skip (Vp, VlevelCap);
+            if (skipping) resume ();
+            Vpot = Vp;
+            //------------------------------------------------------------------
             // DC Threshold Vsc Stage, 12AX7 amplifier
-	    //------------------------------------------------------------------
-            Vs1 = -6.0 * ((log(1.0 + exp( Vpot - DC)))
-                        - (log(1.0 + exp(-Vpot - DC))));
-	    //------------------------------------------------------------------
+            //      -6 * (log(1 + exp(Vpot - DC)) - log(1 + exp(-Vpot - DC)))
+            //------------------------------------------------------------------
+            Vs1 = threshold.process (Vpot);
+            //------------------------------------------------------------------
             // Drive stage, 12BH7 + 6973 amplifier stages
-	    //------------------------------------------------------------------
-	    Vdiff = fabs (hardclip (8.4 * Vs1, -100.0, 100.0)) - VlevelCap;
-	    //------------------------------------------------------------------
+            //      |hardclip(8.4 * Vs1, -100, 100)|
+            //------------------------------------------------------------------
+            Vdiff = fabs (drive.process (Vs1)) - VlevelCap;
+            //------------------------------------------------------------------
             // The nominal output current through the bridge rectifier
             // is calculated using a diode model in series with a resistance.
-	    //------------------------------------------------------------------
-	    Inom = 0.000375 * log(1.0 + exp(((10.0 * Vdiff) / 0.6) - 10.0)) * 0.0125;
-	    //------------------------------------------------------------------
-	    // One side-saturation (does not saturate negatives)
-	    //------------------------------------------------------------------
-	    return Inom - 0.05 * log(1.0 + exp(((10.0 * Inom) / 0.5) - 10.0));
+            //      0.000375 * log(1 + exp((10 * Vdiff / 0.6) - 10)) * 0.0125
+            // or (diode bridge) the two conducting diodes of the bridge in
+            // series with the 12.8k they see, solved in closed form.
+            //------------------------------------------------------------------
+            if (diodeBridge)
+            {
+                rectifier.incident (Vdiff);
+                rectifier.reflected ();
+                Inom = rectifier.current ();
+            }
+            else Inom = bridge.process (Vdiff);
+            //------------------------------------------------------------------
+            // One side-saturation (does not saturate negatives)
+            //      Inom - 0.05 * log(1 + exp((10 * Inom / 0.5) - 10))
+            //------------------------------------------------------------------
+            return limiter.process (Inom);
         }
-	//----------------------------------------------------------------------
-        inline T hardclip (T x, T min, T max) { return (x < min) ? min
-                                                     : (x > max) ? max
-                                                     :             x; }
         //----------------------------------------------------------------------
     protected:
+        //----------------------------------------------------------------------
+        // restart the antialiased stages from the plain chain at the last
+        // skipped sample (its inputs are their previous inputs)
+        //----------------------------------------------------------------------
+        void resume ()
+        {
+            const T Vs1p = threshold.f.f (lastPot);
+            const T Vdp  = fabs (drive.f.f (Vs1p)) - lastCap;
+            threshold.reset (lastPot);
+            drive.reset (Vs1p);
+            bridge.reset (Vdp);
+            limiter.reset (bridge.f.f (Vdp));
+            skipping = false;
+        }
+        //----------------------------------------------------------------------
+        void refreshQuiet ()
+        {
+            const WDF::Softplus<T>& b = bridge.f;
+            quietPot = 0.5 * DC;
+            quietGain = 12.0 * drive.f.k / (1.0 + exp (DC - quietPot));
+            quietDiff = (quietTolerance > 0.0)
+                      ? (log (quietTolerance / b.s) - b.c) / b.k : -1e30;
+            quietCurrent = limiter.f.f (0.0);
+        }
+        //----------------------------------------------------------------------
+        typedef WDF::Sum<T, WDF::Softplus<T>, WDF::Softplus<T>> Threshold;
+        //----------------------------------------------------------------------
         T DC, AC;
         T Vpot, Vs1, Vdiff, Inom;
         //----------------------------------------------------------------------
+        InputCoupledTransformer<T>          transformer;
+        //----------------------------------------------------------------------
+        WDF::ADAA<T, Threshold>             threshold;
+        WDF::ADAA<T, WDF::HardClip<T>>      drive;
+        WDF::ADAA<T, WDF::Softplus<T>>      bridge;
+        WDF::ADAA<T, WDF::Softplus<T>>      limiter;
+        //----------------------------------------------------------------------
+        WDF::Diode<T>                       rectifier;
+        bool                                diodeBridge;
+        //----------------------------------------------------------------------
+        T quietTolerance;                   // bridge current bound (A)
+        T quietPot, quietGain, quietDiff;   // see quietFloor()
+        T quietCurrent;                     // limiter output at zero
+        bool skipping;
+        T lastPot, lastCap;                 // last skipped sample
+        //----------------------------------------------------------------------
 };
 //==============================================================================
 } // namespace Wavechild670
@@ -37,25 +37,40 @@
 //------------------------------------------------------------------------------
 #include "f670l_NonIdealTransformer.hpp"
 #include "f670l_TubeStage.hpp"
+#include "f670l_Arena.hpp"
 //==============================================================================
 namespace Wavechild670 {
 //==============================================================================
-template <typename T> struct UnitDelay { T a, b; };
+// push/pull Newton statistics (audio thread, read out by the meters)
 //==============================================================================
-template <typename T>
-class BidirectionnalUnitDelay
+struct SolverStats
 {
-    public:
-        //----------------------------------------------------------------------
-        void process ()
-        {
-            unit1.b = unit2.a;
-            unit2.b = unit1.a;
-        }
-        //----------------------------------------------------------------------
-        UnitDelay<T> unit1;
-        UnitDelay<T> unit2;
-        //----------------------------------------------------------------------
+    enum { histogramSize = 16 }; // last bin: histogramSize - 1 or more
+    //--------------------------------------------------------------------------
+    SolverStats () { reset (); }
+    void reset ()
+    {
+        solves = iterations = linear = linearizations = 0; worst = 0;
+        for (int k = 0; k < histogramSize; ++k) histogram[k] = 0;
+    }
+    //--------------------------------------------------------------------------
+    inline void add (int n) { ++solves; iterations += n; worst = jmax (worst, n);
+                              ++histogram[jmin (n, (int) histogramSize - 1)]; }
+    inline void addLinear () { ++linear; }
+    inline void add (const SolverStats& o)
+    {
+        solves += o.solves;
+        iterations += o.iterations;
+        linear += o.linear;
+        linearizations += o.linearizations;
+        worst = jmax (worst, o.worst);
+        for (int k = 0; k < histogramSize; ++k) histogram[k] += o.histogram[k];
+    }
+    //--------------------------------------------------------------------------
+    int64 solves, iterations;
+    int64 linear, linearizations;   // small-signal fast path samples, models
+    int worst;
+    int64 histogram[histogramSize]; // solves per iteration count
 };
 //==============================================================================
 template <typename T>
@@ -68,35 +83,149 @@ class TransformerInputCircuit
 		//----------------------------------------------------------------------
 };
 //==============================================================================
-template <typename T>
-class SignalAmplifier : public WDF::OnePort<T>
+template <typename T, class Tube = Triode6386<T> >
+class SignalAmplifier : public WDF::OnePort<T>, WDF::VectorNewton<T, 2>
 {
+    friend class WDF::VectorNewton<T, 2>;
+    //--------------------------------------------------------------------------
     public:
-        SignalAmplifier (T Fs)
+        SignalAmplifier (T Fs, Arena* arena = nullptr)
             : //----------------------------------------------------------------
               WDF::OnePort<T> (1.0),
-		cathodeTocathode (new BidirectionnalUnitDelay<T>()),
-		transformer (new InputCoupledTransformer<T>()),
-		push (new TubeStage<T>(Fs)),
-		pull (new TubeStage<T>(Fs)),
-		VgateBias (-7.2)
               //----------------------------------------------------------------
+              Ck (2.0*4e-6, Fs, "2C1"),       // cathode capacitor (twice)
+              Vk (-3.1,  705.0, "Vbal R11"),  // cathode (balance)
+              cathode (numNodes, "K"),
+              //----------------------------------------------------------------
+              VgateBias (-7.2),
+              //----------------------------------------------------------------
+              failures (0),
+              linearTolerance (1e-6), linearReady (false), holdoff (0)
         {
-	    push->wiring (pull);
-	    pull->wiring (push);
-	}
+            transformer.create (arena);
+            push.create (arena, Fs);
+            pull.create (arena, Fs);
+            //------------------------------------------------------------------
+            wiring ();
+            transformer->prepareBlock ();
+        }
+        //----------------------------------------------------------------------
+        // arena bytes taken by the transformer and tubes (see Arena)
+        //----------------------------------------------------------------------
+        static size_t storageSize ()
+        {
+            return Arena::round (sizeof (InputCoupledTransformer<T>))
+                 + Arena::round (sizeof (TubeStage<T, Tube>)) * 2;
+        }
         //----------------------------------------------------------------------
         virtual String label () const { return "Amp"; }
-	//----------------------------------------------------------------------
+        //----------------------------------------------------------------------
         virtual inline T process (T Vin, T VlevelCap)
         {
-            T Vgate = transformer->process (Vin);
-            T VoutPush = push->process (VgateBias - VlevelCap + Vgate);
-            T VoutPull = pull->process (VgateBias - VlevelCap + Vgate);
-            cathodeTocathode->process ();
-            return VoutPush - VoutPull;
+            return processTubes (transformer->process (Vin), VlevelCap);
+        }
+        //----------------------------------------------------------------------
+        // Block mode: the input transformer runs over the whole block first
+        // (linear, feed-forward), then processTubes() is called per sample.
+        //----------------------------------------------------------------------
+        inline void transformBlock (const T* Vin, T* Vgate, int numSamples)
+        {
+            transformer->processBlock (Vin, Vgate, numSamples);
+        }
+        //----------------------------------------------------------------------
+        // Both triodes share the cathode node: they are the two unadapted
+        // ports of the cathode R-type junction and their plate currents are
+        // solved jointly each sample (no delay between push and pull sides).
+        //----------------------------------------------------------------------
+        inline T processTubes (T Vgate, T VlevelCap)
+        {
+            Vg[0] = VgateBias - VlevelCap + Vgate;      // push
+            Vg[1] = VgateBias - VlevelCap - Vgate;      // pull
+            //------------------------------------------------------------------
+            // port voltages and cathode voltage are affine in the currents:
+            //      v = v0 - Z.i        VK = VK0 - q.i
+            //------------------------------------------------------------------
+            cathode.gather ();
+            const T c0 = cathode.partial (ports[0]);
+            const T c1 = cathode.partial (ports[1]);
+            v0[0] = Ainv[0]*c0 + Ainv[1]*c1;
+            v0[1] = Ainv[2]*c0 + Ainv[3]*c1;
+            VK0 = cathode.nodeVoltage (K)
+                + cathode.weight (K, ports[0]) * v0[0]
+                + cathode.weight (K, ports[1]) * v0[1];
+            //------------------------------------------------------------------
+            if (linearReady && linearStep ())
+            {
+                stats.addLinear ();
+                this->resetPredictor ();
+            }
+            else
+            {
+                stats.add (this->solve (*this));        // warm started, inlined
+                if (! this->converged) ++failures;
+                updateLinear ();
+            }
+            //------------------------------------------------------------------
+            T waves[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                const T v = v0[j] - Z[2*j]*x[0] - Z[2*j + 1]*x[1];
+                waves[j] = v - Rtube * x[j];
+            }
+            cathode.scatter (ports, waves, 2);
+            return push->Vout() - pull->Vout();
+        }
+        //----------------------------------------------------------------------
+        // joint Newton quality (see Governor)
+        //----------------------------------------------------------------------
+        void setSolverQuality (T tolerance, int iterations, int halvings)
+        {
+            this->epsilon = tolerance;
+            this->maxIterations = iterations;
+            this->maxHalvings = halvings;
+        }
+        //----------------------------------------------------------------------
+        // starting point of the joint solve (WDF::NewtonPredictor)
+        //----------------------------------------------------------------------
+        void setPredictor (int p)
+        {
+            this->predictor = jlimit (0, (int) WDF::numPredictors - 1, p);
+        }
+        //----------------------------------------------------------------------
+        // small-signal fast path: the linearized triodes are used while the
+        // estimate of their current error stays below tolerance x current
+        // (0 = always solve)
+        //----------------------------------------------------------------------
+        void setLinearTolerance (T tolerance)
+        {
+            linearTolerance = jmax ((T) 0.0, tolerance);
+            linearReady = false; holdoff = 0;
+        }
+        //----------------------------------------------------------------------
+        SolverStats& getSolverStats () { return stats; }
+        //----------------------------------------------------------------------
+        // anode current of the last sample (0 = push, 1 = pull)
+        //----------------------------------------------------------------------
+        T getCurrent (int side) const { return this->x[side & 1]; }
+        //----------------------------------------------------------------------
+        // solves that ended above the tolerance since the last call
+        //----------------------------------------------------------------------
+        int takeFailures () { const int n = failures; failures = 0; return n; }
+        //----------------------------------------------------------------------
+        // running states (transformers, cathode capacitor, Newton guesses)
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
+        {
+            transformer->state (s);
+            push->state (s);
+            pull->state (s);
+            T c = Ck.getState (); s.io (c); Ck.setState (c);
+            s.io (x, 2);
+            this->resetPredictor ();
+            linearReady = false; holdoff = 0;
         }
-	//----------------------------------------------------------------------
+        //----------------------------------------------------------------------
         virtual inline T reflected ()
         {
             b = 0.0; return b;
@@ -104,21 +233,182 @@ class SignalAmplifier : public WDF::OnePort<T>
         //----------------------------------------------------------------------
         virtual inline void incident (T value)
         {
-	    a = value;
+            a = value;
         }
         //----------------------------------------------------------------------
     protected:
         //----------------------------------------------------------------------
         // Fairchild 670 Class-A Signal Amplifier model
         //----------------------------------------------------------------------
-        ScopedPointer<BidirectionnalUnitDelay<T>> cathodeTocathode;
-        ScopedPointer<InputCoupledTransformer<T>> transformer;
-        ScopedPointer<TubeStage<T>> push; // GE 6386
-        ScopedPointer<TubeStage<T>> pull; // GE 6386
-	T VgateBias;
+        //
+        //         P1 --[ push plate ]-- gnd      P2 --[ pull plate ]-- gnd
+        //         P1 ==( push triode )== K       P2 ==( pull triode )== K
+        //          K --[ Vbal R11 ]-- gnd         K --[ 2C1 ]-- gnd
+        //
+        //----------------------------------------------------------------------
+        enum { ground, K, P1, P2, numNodes };
+        //----------------------------------------------------------------------
+        inline void wiring ()
+        {
+            cathode.addChild (push->plate (), P1, ground);
+            cathode.addChild (pull->plate (), P2, ground);
+            cathode.addChild (&Vk, K, ground);
+            cathode.addChild (&Ck, K, ground);
+            ports[0] = cathode.addExternal (P1, K, Rtube);
+            ports[1] = cathode.addExternal (P2, K, Rtube);
+            cathode.connect ();
+            //------------------------------------------------------------------
+            // external block of S: (I - See).v = c - R.(I + See).i
+            //------------------------------------------------------------------
+            T See[4], A[4];
+            for (int j = 0; j < 2; ++j)
+                for (int k = 0; k < 2; ++k)
+                {
+                    See[2*j + k] = cathode.scattering (ports[j], ports[k]);
+                    A[2*j + k] = ((j == k) ? 1.0 : 0.0) - See[2*j + k];
+                }
+            const T det = A[0]*A[3] - A[1]*A[2];
+            Ainv[0] =  A[3]/det; Ainv[1] = -A[1]/det;
+            Ainv[2] = -A[2]/det; Ainv[3] =  A[0]/det;
+            //------------------------------------------------------------------
+            for (int j = 0; j < 2; ++j)
+                for (int k = 0; k < 2; ++k)
+                    Z[2*j + k] = Rtube * (Ainv[2*j + k]
+                               + Ainv[2*j]*See[k] + Ainv[2*j + 1]*See[2 + k]);
+            //------------------------------------------------------------------
+            // VK = VKc + w.(v - R.i)
+            //------------------------------------------------------------------
+            for (int k = 0; k < 2; ++k)
+                q[k] = cathode.weight (K, ports[0]) * Z[k]
+                     + cathode.weight (K, ports[1]) * Z[2 + k]
+                     + cathode.weight (K, ports[k]) * Rtube;
+        }
+        //----------------------------------------------------------------------
+        // F(i) = i - Ia (Vg - VK(i), v(i))
+        //----------------------------------------------------------------------
+        virtual inline void evaluate (const T* i, T* F, T* J)
+        {
+            const T VK = VK0 - q[0]*i[0] - q[1]*i[1];
+            TubeStage<T, Tube>* tube[2] = { push, pull };
+            for (int j = 0; j < 2; ++j)
+            {
+                const T v = v0[j] - Z[2*j]*i[0] - Z[2*j + 1]*i[1];
+                T dVgk, dVak;
+                const T Ia = tube[j]->current (Vg[j] - VK, v, dVgk, dVak);
+                F[j] = i[j] - Ia;
+                for (int k = 0; k < 2; ++k)
+                    J[2*j + k] = ((j == k) ? 1.0 : 0.0)
+                               - dVgk*q[k] + dVak*Z[2*j + k];
+                //--------------------------------------------------------------
+                // the last evaluation of a solve is at its solution
+                //--------------------------------------------------------------
+                lin[j].Ia = Ia; lin[j].Vgk = Vg[j] - VK; lin[j].Vak = v;
+                lin[j].gm = dVgk; lin[j].ga = dVak;
+            }
+        }
+        //----------------------------------------------------------------------
+        // explicit update with the small-signal models: the same 2 x 2
+        // linear system as linearizedGuess(), accepted when both triodes
+        // stay in range and their error estimate within tolerance
+        //----------------------------------------------------------------------
+        inline bool linearStep ()
+        {
+            T M[4], r[2], i[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int k = 0; k < 2; ++k)
+                    M[2*j + k] = ((j == k) ? 1.0 : 0.0)
+                               - op[j].gm*q[k] + op[j].ga*Z[2*j + k];
+                r[j] = op[j].I + op[j].gm * (Vg[j] - VK0 - op[j].Vgk)
+                               + op[j].ga * (v0[j] - op[j].Vak);
+            }
+            const T det = M[0]*M[3] - M[1]*M[2];
+            if (det == 0.0) return reject ();
+            i[0] = (M[3]*r[0] - M[1]*r[1]) / det;
+            i[1] = (M[0]*r[1] - M[2]*r[0]) / det;
+            //------------------------------------------------------------------
+            const T VK = VK0 - q[0]*i[0] - q[1]*i[1];
+            for (int j = 0; j < 2; ++j)
+            {
+                const T Vgk = Vg[j] - VK;
+                const T Vak = v0[j] - Z[2*j]*i[0] - Z[2*j + 1]*i[1];
+                if (Vgk > 0.0 || Vak <= 0.0) return reject ();
+                if (op[j].errorEstimate (Vgk, Vak) > linearTolerance * fabs (op[j].I))
+                    return reject ();
+            }
+            x[0] = i[0]; x[1] = i[1];
+            return true;
+        }
+        //----------------------------------------------------------------------
+        // out of the linear region: solve for a while before relinearizing
+        //----------------------------------------------------------------------
+        inline bool reject ()
+        {
+            linearReady = false; holdoff = linearHoldoff;
+            return false;
+        }
+        //----------------------------------------------------------------------
+        // after a solve, linearize at its solution once the holdoff is over
+        //----------------------------------------------------------------------
+        inline void updateLinear ()
+        {
+            if (linearTolerance <= 0.0) return;
+            if (holdoff > 0) { --holdoff; return; }
+            push->linearize (lin[0].Vgk, lin[0].Vak, op[0]);
+            pull->linearize (lin[1].Vgk, lin[1].Vak, op[1]);
+            ++stats.linearizations;
+            linearReady = true;
+        }
+        //----------------------------------------------------------------------
+        // linearizedPredictor: both triodes linearized at the previous
+        // solution, Ia = Ia0 + gm.dVgk + ga.dVak, give a linear system in
+        // the currents at the new sample (its matrix is the last Jacobian)
+        //----------------------------------------------------------------------
+        inline void linearizedGuess (T* i)
+        {
+            T M[4], r[2];
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int k = 0; k < 2; ++k)
+                    M[2*j + k] = ((j == k) ? 1.0 : 0.0)
+                               - lin[j].gm*q[k] + lin[j].ga*Z[2*j + k];
+                r[j] = lin[j].Ia + lin[j].gm * (Vg[j] - VK0 - lin[j].Vgk)
+                                 + lin[j].ga * (v0[j] - lin[j].Vak);
+            }
+            const T det = M[0]*M[3] - M[1]*M[2];
+            if (det == 0.0) return;
+            i[0] = (M[3]*r[0] - M[1]*r[1]) / det;
+            i[1] = (M[0]*r[1] - M[2]*r[0]) / det;
+        }
+        //----------------------------------------------------------------------
+        Placed<InputCoupledTransformer<T>> transformer;
+        Placed<TubeStage<T, Tube>> push; // GE 6386 by default
+        Placed<TubeStage<T, Tube>> pull;
+        //----------------------------------------------------------------------
+        WDF::Capacitor<T>       Ck;
+        WDF::VoltageSource<T>   Vk;
+        WDF::RType<T>           cathode;
+        //----------------------------------------------------------------------
+        static const T Rtube;   // triode ports resistance
+        int ports[2];           // triode ports on the cathode junction
+        T Ainv[4], Z[4], q[2];  // junction seen from the triodes
+        T v0[2], VK0, Vg[2];    // current sample
+        struct { T Ia, Vgk, Vak, gm, ga; } lin[2]; // triodes at the last solve
+        SolverStats stats;
+        int failures;           // unconverged solves (governor)
+        //----------------------------------------------------------------------
+        T VgateBias;
+        //----------------------------------------------------------------------
+        enum { linearHoldoff = 32 };                // samples
+        typename TubeStage<T, Tube>::SmallSignal op[2]; // fast path models
+        T linearTolerance;
+        bool linearReady;
+        int holdoff;
         //----------------------------------------------------------------------
 };
 //==============================================================================
+template <typename T, class Tube> const T SignalAmplifier<T, Tube>::Rtube = 2000.0;
+//==============================================================================
 } // namespace Wavechild670
 //==============================================================================
 #endif  // __F670L_SIGNALAMPLIFIER_HPP_F90DF875__
@@ -0,0 +1,332 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_SNAPSHOT_HPP_6C2A91E4__
+#define __F670L_SNAPSHOT_HPP_6C2A91E4__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_StereoProcessor.hpp"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Warm-state snapshot
+//------------------------------------------------------------------------------
+// A flat array of every running state of the circuit (reactive elements,
+// Newton guesses, antialiasing history, level cap voltages). Each class
+// visits its states with a single template member:
+//
+//      template <class Archive> void state (Archive& s) { s.io (x); ... }
+//
+// which is used both ways (save fills the array, restore reads it back in
+// the same order), so a clone is one linear copy of the values. Restore
+// checks the layout with a counting pass and does not allocate.
+//==============================================================================
+template <typename T>
+class Snapshot
+{
+    public:
+        Snapshot () : position (0), mode (saving) {}
+        //----------------------------------------------------------------------
+        template <class Object>
+        void save (Object& object)
+        {
+            values.clearQuick ();
+            position = 0; mode = saving;
+            object.state (*this);
+        }
+        //----------------------------------------------------------------------
+        template <class Object>
+        bool restore (Object& object)
+        {
+            position = 0; mode = counting;  // never restore a partial state
+            object.state (*this);
+            const bool match = (position == values.size());
+            //------------------------------------------------------------------
+            position = 0; mode = loading;
+            if (match) object.state (*this);
+            mode = saving;
+            return match;
+        }
+        //----------------------------------------------------------------------
+        inline void io (T& v)
+        {
+            if (mode == saving) { values.add (v); return; }
+            if (mode == loading && position < values.size())
+                v = values.getUnchecked (position);
+            ++position;
+        }
+        //----------------------------------------------------------------------
+        inline void io (T* v, int n) { for (int i = 0; i < n; ++i) io (v[i]); }
+        //----------------------------------------------------------------------
+        int size () const { return values.size(); }
+        const T* getData () const { return values.getRawDataPointer(); }
+        //----------------------------------------------------------------------
+        void setData (const T* data, int n)
+        {
+            values.clearQuick ();
+            values.addArray (data, n);
+        }
+        //----------------------------------------------------------------------
+        // binary form (session state): magic, version, count, values
+        //----------------------------------------------------------------------
+        enum { magic = 0x57363730, version = 1 }; // "W670"
+        //----------------------------------------------------------------------
+        void write (OutputStream& out) const
+        {
+            out.writeInt (magic);
+            out.writeInt (version);
+            out.writeInt (values.size());
+            out.write (getData(), values.size() * sizeof (T));
+        }
+        //----------------------------------------------------------------------
+        bool read (InputStream& in)
+        {
+            if (in.readInt() != magic || in.readInt() != version) return false;
+            const int n = in.readInt();
+            if (n < 0 || in.getNumBytesRemaining() < (int64) (n * sizeof (T)))
+                return false;
+            values.resize (n);
+            in.read (values.getRawDataPointer(), n * sizeof (T));
+            return true;
+        }
+        //----------------------------------------------------------------------
+    private:
+        enum { saving, loading, counting };
+        //----------------------------------------------------------------------
+        Array<T> values;
+        int position, mode;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// Snapshot handed from the message thread to the audio thread
+//------------------------------------------------------------------------------
+// read() decodes into the single slot (a snapshot still staged is replaced,
+// it only waits while the audio thread is applying one); apply() restores
+// it between blocks, without locks or allocation.
+//==============================================================================
+template <typename T>
+class StagedSnapshot
+{
+    public:
+        StagedSnapshot () { stage = idle; }
+        //----------------------------------------------------------------------
+        // message thread
+        //----------------------------------------------------------------------
+        bool read (InputStream& in)
+        {
+            while (! stage.compareAndSetBool (writing, idle)
+                && ! stage.compareAndSetBool (writing, staged))
+                Thread::yield ();
+            //------------------------------------------------------------------
+            const bool ok = snapshot.read (in);
+            stage = ok ? staged : idle;
+            return ok;
+        }
+        //----------------------------------------------------------------------
+        // drop a staged snapshot (the processor was prepared again)
+        //----------------------------------------------------------------------
+        void discard () { stage.compareAndSetBool (idle, staged); }
+        //----------------------------------------------------------------------
+        // audio thread
+        //----------------------------------------------------------------------
+        bool isPending () const { return stage.get () == staged; }
+        //----------------------------------------------------------------------
+        template <class Object>
+        bool apply (Object& object)
+        {
+            if (! stage.compareAndSetBool (applying, staged)) return false;
+            const bool ok = snapshot.restore (object);
+            stage = idle;
+            return ok;
+        }
+        //----------------------------------------------------------------------
+    private:
+        enum { idle, writing, staged, applying };
+        //----------------------------------------------------------------------
+        Snapshot<T> snapshot;
+        Atomic<int> stage;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (StagedSnapshot)
+};
+//==============================================================================
+// Persistent warm-state cache
+//------------------------------------------------------------------------------
+// Append-only file of warmed-up snapshots keyed by every setting warmup()
+// depends on (sample rate, time constants A/B, linked, antialiasing orders,
+// rectifier topology),
+// read through a memory map. The first instance at a given key pays for
+// warmup(), every later one (in any process) copies the values.
+//
+//      header : "W67C", version, value size, layout size
+//      entry  : Fs (double), tcA, tcB, linked, antialiasing,
+//               clipAntialiasing, diodeBridge, count (int32), count values
+//==============================================================================
+template <typename T>
+class WarmStateCache
+{
+    public:
+        WarmStateCache (const File& f = defaultFile())
+            : file (f), lock ("Wavechild670WarmStateCache")
+        {}
+        //----------------------------------------------------------------------
+        static File defaultFile ()
+        {
+            return File::getSpecialLocation (File::userApplicationDataDirectory)
+                        .getChildFile ("Wavechild670")
+                        .getChildFile ("warmstate.cache");
+        }
+        //----------------------------------------------------------------------
+        struct Key
+        {
+            double Fs;
+            int32 tcA, tcB, linked, antialiasing, clipAntialiasing, diodeBridge;
+            int32 count;
+            //------------------------------------------------------------------
+            static Key of (const StereoProcessor<T>& p, int count)
+            {
+                const Key k = { p.Fs, p.tcA, p.tcB, p.linked ? 1 : 0,
+                                p.antialiasing, p.clipAntialiasing,
+                                p.diodeBridge ? 1 : 0, count };
+                return k;
+            }
+            //------------------------------------------------------------------
+            bool operator== (const Key& k) const
+            {
+                return Fs == k.Fs && tcA == k.tcA && tcB == k.tcB
+                    && linked == k.linked && antialiasing == k.antialiasing
+                    && clipAntialiasing == k.clipAntialiasing
+                    && diodeBridge == k.diodeBridge && count == k.count;
+            }
+        };
+        //----------------------------------------------------------------------
+        bool find (const Key& key, Snapshot<T>& s)
+        {
+            const int layout = key.count;
+            const InterProcessLock::ScopedLockType sl (lock);
+            if (! file.existsAsFile ()) return false;
+            //------------------------------------------------------------------
+            MemoryMappedFile map (file, MemoryMappedFile::readOnly);
+            const char* p   = static_cast<const char*> (map.getData());
+            const char* end = p + map.getSize();
+            if (p == nullptr || ! validHeader (p, end, layout)) return false;
+            //------------------------------------------------------------------
+            for (p += sizeof (Header); p + sizeof (Key) <= end;)
+            {
+                Key e; memcpy (&e, p, sizeof (Key));
+                const char* data = p + sizeof (Key);
+                if (e.count < 0 || e.count > (end - data) / (int) sizeof (T))
+                    break; // truncated
+                p = data + e.count * sizeof (T);
+                if (e == key)
+                {
+                    s.setData (reinterpret_cast<const T*> (data), e.count);
+                    return true;
+                }
+            }
+            return false;
+        }
+        //----------------------------------------------------------------------
+        bool add (const Key& key, const Snapshot<T>& s)
+        {
+            jassert (key.count == s.size());
+            const InterProcessLock::ScopedLockType sl (lock);
+            //------------------------------------------------------------------
+            // a stale layout (older build) invalidates the whole file
+            //------------------------------------------------------------------
+            if (file.existsAsFile ())
+            {
+                MemoryMappedFile map (file, MemoryMappedFile::readOnly);
+                const char* p = static_cast<const char*> (map.getData());
+                if (p == nullptr || ! validHeader (p, p + map.getSize(), s.size()))
+                    file.deleteFile ();
+            }
+            //------------------------------------------------------------------
+            const bool fresh = ! file.existsAsFile ();
+            if (fresh) file.create ();
+            FileOutputStream out (file);
+            if (out.failedToOpen ()) return false;
+            //------------------------------------------------------------------
+            if (fresh)
+            {
+                const Header h = { headerMagic, headerVersion,
+                                   (int32) sizeof (T), s.size() };
+                out.write (&h, sizeof (Header));
+            }
+            out.write (&key, sizeof (Key));
+            out.write (s.getData(), s.size() * sizeof (T));
+            out.flush ();
+            return ! out.getStatus().failed();
+        }
+        //----------------------------------------------------------------------
+    private:
+        struct Header { int32 magic, version, valueSize, layout; };
+        enum { headerMagic = 0x57363743, headerVersion = 3 }; // "W67C"
+        //----------------------------------------------------------------------
+        static bool validHeader (const char* p, const char* end, int layout)
+        {
+            if (p + sizeof (Header) > end) return false;
+            Header h; memcpy (&h, p, sizeof (Header));
+            return h.magic == headerMagic
+                && h.version == headerVersion
+                && h.valueSize == (int32) sizeof (T)
+                && h.layout == layout;
+        }
+        //----------------------------------------------------------------------
+        File file;
+        InterProcessLock lock;
+        //----------------------------------------------------------------------
+};
+//==============================================================================
+// init + warm state: from the cache when possible, else warmup() once and
+// store the result for every later instance
+//==============================================================================
+template <typename T>
+static void warmStart (StereoProcessor<T>& processor)
+{
+    Snapshot<T> snapshot;
+    snapshot.save (processor);              // layout of this build
+    const int layout = snapshot.size();
+    //--------------------------------------------------------------------------
+    WarmStateCache<T> cache;
+    const typename WarmStateCache<T>::Key key = WarmStateCache<T>::Key::of (processor, layout);
+    if (cache.find (key, snapshot) && snapshot.restore (processor))
+        return;
+    //--------------------------------------------------------------------------
+    processor.warmup ();
+    snapshot.save (processor);
+    cache.add (key, snapshot);
+}
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_SNAPSHOT_HPP_6C2A91E4__
+//==============================================================================
\ No newline at end of file
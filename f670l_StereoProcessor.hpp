@@ -35,6 +35,10 @@
 #include "f670l_SignalAmplifier.hpp"
 #include "f670l_LevelTimeConstant.hpp"
 #include "f670l_SidechainAmplifier.hpp"
+#include "f670l_SampleFormat.hpp"
+#include "f670l_Metering.hpp"
+#include "f670l_Profiling.hpp"
+#include "f670l_Arena.hpp"
 //==============================================================================
 namespace Wavechild670 {
 //==============================================================================
@@ -46,6 +50,7 @@ class StereoProcessor
     public:
         StereoProcessor ()
             : Fs (44100.0),       gain (1.0),
+              blockSize (0),
               //-------------------------
                    A (0.0),          B (0.0),
                 capA (0.0),       capB (0.0),
@@ -56,29 +61,80 @@ class StereoProcessor
               hardclipout (true),
                  feedback (false),
                   midside (false),
-                   linked (true)
+                   linked (true),
+              antialiasing (0),
+              clipAntialiasing (0),
+              diodeBridge (false),
+              shared (false),
+              meter (nullptr),
+              profiler (nullptr),
+              arena (nullptr),
+              gateA (nullptr), gateB (nullptr), capBufA (nullptr), capBufB (nullptr),
+              potA (nullptr), potB (nullptr),
+              clipL (WDF::HardClip<T> (-1.0, 1.0), 0),
+              clipR (WDF::HardClip<T> (-1.0, 1.0), 0)
         {}
         //----------------------------------------------------------------------
-        void init (T sampleRate)
+        void init (T sampleRate, int maxBlockSize = 512, bool warm = true)
         {
             Fs = sampleRate;
             //------------------------------------------------------------------
-            signalAmpA = new SignalAmplifier<double> (Fs);
-            signalAmpB = new SignalAmplifier<double> (Fs);
+            blockSize = jmax (1, maxBlockSize);
             //------------------------------------------------------------------
-            sidechainAmpA = new SidechainAmplifier<double> (Fs);
-            sidechainAmpB = new SidechainAmplifier<double> (Fs);
+            // the whole state in the arena when there is one (see setArena)
             //------------------------------------------------------------------
-            timeConstantA = new LevelTimeConstant<double> (Fs);
-            timeConstantB = new LevelTimeConstant<double> (Fs);
+            release ();
+            if (arena != nullptr) arena->clear ();
+            //------------------------------------------------------------------
+            signalAmpA.create (arena, Fs, arena);
+            signalAmpB.create (arena, Fs, arena);
+            //------------------------------------------------------------------
+            sidechainAmpA.create (arena, Fs);
+            sidechainAmpB.create (arena, Fs);
+            //------------------------------------------------------------------
+            timeConstantA.create (arena, Fs);
+            timeConstantB.create (arena, Fs);
+            //------------------------------------------------------------------
+            const size_t bytes = scratchSize (blockSize);
+            T* block = (T*) ((arena != nullptr) ? arena->allocate (bytes) : nullptr);
+            if (block == nullptr) { scratch.allocate (bytes / sizeof (T), true);
+                                    block = scratch; }
+            else                  { scratch.free (); zeromem (block, bytes); }
+            T** buffers[] = { &gateA, &gateB, &capBufA, &capBufB, &potA, &potB };
+            for (int k = 0; k < numScratch; ++k) *buffers[k] = block + k * blockSize;
             //------------------------------------------------------------------
             timeConstantA->parameters (Fs, tcA);
             timeConstantB->parameters (Fs, tcB);
             //------------------------------------------------------------------
+            setAntialiasing (antialiasing);
+            setDiodeBridge (diodeBridge);
+            clipL.reset (); clipR.reset ();
+            //------------------------------------------------------------------
             capA = A = 0.0;
             capB = B = 0.0;
             //------------------------------------------------------------------
-            warmup ();
+            if (warm) warmup (); // else see warmStart() (f670l_Snapshot.hpp)
+        }
+        //----------------------------------------------------------------------
+        // per-instance storage for the amplifiers, time constants and block
+        // scratch (ProcessingEngine slots), used by the next init(). The
+        // state is released here: call init() before processing again.
+        //----------------------------------------------------------------------
+        void setArena (Arena* a)
+        {
+            release ();
+            arena = a;
+        }
+        //----------------------------------------------------------------------
+        // arena bytes init() takes at a block size
+        //----------------------------------------------------------------------
+        static size_t stateSize (int maxBlockSize)
+        {
+            return 2 * (Arena::round (sizeof (SignalAmplifier<T>))
+                        + SignalAmplifier<T>::storageSize ()
+                        + Arena::round (sizeof (SidechainAmplifier<T>))
+                        + Arena::round (sizeof (LevelTimeConstant<T>)))
+                 + Arena::round (scratchSize (jmax (1, maxBlockSize)));
         }
         //----------------------------------------------------------------------
         void parameters (const int tA, const int tB)
@@ -87,37 +143,187 @@ class StereoProcessor
             tcB = tB; timeConstantB->parameters (Fs, tcB);
         }
         //----------------------------------------------------------------------
-        inline T sidechain (T VscA, T VscB)
+        // every running state, see Snapshot (f670l_Snapshot.hpp)
+        //----------------------------------------------------------------------
+        template <class Archive>
+        void state (Archive& s)
         {
-            T IscA = sidechainAmpA->process (VscA, capA);
-            T IscB = sidechainAmpB->process (VscB, capB);
-
+            s.io (A); s.io (B); s.io (capA); s.io (capB);
+            signalAmpA->state (s);    signalAmpB->state (s);
+            sidechainAmpA->state (s); sidechainAmpB->state (s);
+            timeConstantA->state (s); timeConstantB->state (s);
+            clipL.state (s);          clipR.state (s);
+        }
+        //----------------------------------------------------------------------
+        // push/pull solver tolerance, iteration and line search caps
+        //----------------------------------------------------------------------
+        void setSolverQuality (T tolerance, int iterations, int halvings)
+        {
+            signalAmpA->setSolverQuality (tolerance, iterations, halvings);
+            signalAmpB->setSolverQuality (tolerance, iterations, halvings);
+        }
+        //----------------------------------------------------------------------
+        // small-signal fast path of the push/pull pairs (0 = always solve)
+        //----------------------------------------------------------------------
+        void setLinearTolerance (T tolerance)
+        {
+            signalAmpA->setLinearTolerance (tolerance);
+            signalAmpB->setLinearTolerance (tolerance);
+        }
+        //----------------------------------------------------------------------
+        // push/pull Newton starting point (WDF::NewtonPredictor)
+        //----------------------------------------------------------------------
+        void setPredictor (int predictor)
+        {
+            signalAmpA->setPredictor (predictor);
+            signalAmpB->setPredictor (predictor);
+        }
+        //----------------------------------------------------------------------
+        // push/pull Newton statistics of both channels since the last call
+        //----------------------------------------------------------------------
+        SolverStats takeSolverStats ()
+        {
+            SolverStats& a = signalAmpA->getSolverStats ();
+            SolverStats& b = signalAmpB->getSolverStats ();
+            SolverStats s = a; s.add (b);
+            a.reset (); b.reset ();
+            return s;
+        }
+        //----------------------------------------------------------------------
+        // push/pull solves of both channels that did not converge since the
+        // last call (Governor)
+        //----------------------------------------------------------------------
+        int takeSolverFailures ()
+        {
+            return signalAmpA->takeFailures () + signalAmpB->takeFailures ();
+        }
+        //----------------------------------------------------------------------
+        // antiderivative antialiasing of the sidechain stages (0 = off,
+        // default; 1 = half a sample of delay, 2 = one sample of delay).
+        // Opt-in: there is no oversampling it replaces, so it only adds cost
+        //----------------------------------------------------------------------
+        void setAntialiasing (int order)
+        {
+            antialiasing = jlimit (0, 2, order);
+            if (sidechainAmpA != nullptr) sidechainAmpA->setAntialiasing (antialiasing);
+            if (sidechainAmpB != nullptr) sidechainAmpB->setAntialiasing (antialiasing);
+        }
+        //----------------------------------------------------------------------
+        // antiderivative antialiasing of the output clip (0 = off, default).
+        // Below the clip ADAA is an FIR on the signal itself: order 1 is the
+        // two-tap average (-6 dB at Fs/3, half a sample of delay), so it is
+        // only worth it when the clip is driven hard
+        //----------------------------------------------------------------------
+        void setClipAntialiasing (int order)
+        {
+            clipAntialiasing = jlimit (0, 2, order);
+            clipL.setOrder (clipAntialiasing);
+            clipR.setOrder (clipAntialiasing);
+        }
+        //----------------------------------------------------------------------
+        // sidechain bridge rectifier: softplus (default) or diode circuit
+        //----------------------------------------------------------------------
+        void setDiodeBridge (bool diodes)
+        {
+            diodeBridge = diodes;
+            if (sidechainAmpA != nullptr) sidechainAmpA->setDiodeBridge (diodeBridge);
+            if (sidechainAmpB != nullptr) sidechainAmpB->setDiodeBridge (diodeBridge);
+        }
+        //----------------------------------------------------------------------
+        // sidechain below-threshold early-out (bridge current tolerance in
+        // amps, 0 = always run the detector)
+        //----------------------------------------------------------------------
+        void setQuietTolerance (T amps)
+        {
+            sidechainAmpA->setQuietTolerance (amps);
+            sidechainAmpB->setQuietTolerance (amps);
+        }
+        //----------------------------------------------------------------------
+        // metering channel to the editor (see f670l_Metering.hpp), nullptr
+        // to disable. publishMeter() ends a metered block.
+        //----------------------------------------------------------------------
+        void setMeter (Meter* m) { meter = m; }
+        Meter* getMeter () const { return meter; }
+        //----------------------------------------------------------------------
+        void publishMeter () { publishMeter (capA, capB); }
+        void publishMeter (T cA, T cB)
+        {
+            if (meter == nullptr) return;
+            meter->publish (cA, cB, takeSolverStats ());
+        }
+        //----------------------------------------------------------------------
+        // per-stage profiling (see f670l_Profiling.hpp), nullptr to disable
+        //----------------------------------------------------------------------
+        void setProfiler (Profiling::Profiler* p) { profiler = p; }
+        //----------------------------------------------------------------------
+        inline void sidechain (T VscA, T VscB)
+        {
+            const T IscA = sidechainAmpA->process (VscA, capA);
+            const T IscB = sidechainAmpB->process (VscB, capB);
+            timeConstant (IscA, IscB);
+        }
+        //----------------------------------------------------------------------
+        // feed-forward block: the threshold transformers run over the block,
+        // then per sample the detectors are skipped while the level caps
+        // stay above the floor of the block peak (see SidechainAmplifier)
+        //----------------------------------------------------------------------
+        inline void sidechainBlock (const T *gA, const T *gB, T *cA, T *cB, int n)
+        {
+            T floorA, floorB;
+            {
+                WAVECHILD670_PROFILE_STAGE (profiler, transformerStage);
+                floorA = sidechainAmpA->quietFloor (sidechainAmpA->potBlock (gA, potA, n));
+                floorB = sidechainAmpB->quietFloor (sidechainAmpB->potBlock (gB, potB, n));
+            }
+            WAVECHILD670_PROFILE_STAGE (profiler, sidechainStage);
+            int i = 0;
+            for (; i < n; ++i)
+            {
+                const T IscA = (capA >= floorA) ? sidechainAmpA->skip (potA[i], capA)
+                                                : sidechainAmpA->detect (potA[i], capA);
+                const T IscB = (capB >= floorB) ? sidechainAmpB->skip (potB[i], capB)
+                                                : sidechainAmpB->detect (potB[i], capB);
+                timeConstant (IscA, IscB);
+                cA[i] = capA; cB[i] = capB;
+            }
+        }
+        //----------------------------------------------------------------------
+        inline void timeConstant (T IscA, T IscB)
+        {
+            //------------------------------------------------------------------
+            // linked: both networks run on the averaged current and the caps
+            // take the mean of their voltages. With equal time constants the
+            // networks are identical, A runs alone (from the mean of both
+            // states, so linking does not jump to A's gain) and B takes its
+            // state back as soon as they differ again (unlink or time
+            // constant change)
+            //------------------------------------------------------------------
+            if (linked && tcA == tcB)
+            {
+                if (! shared) timeConstantA->averageState (*timeConstantB);
+                capA =
+                capB = timeConstantA->process ((IscA + IscB) * 0.5);
+                shared = true;
+                return;
+            }
+            if (shared) { timeConstantB->copyState (*timeConstantA); shared = false; }
+            //------------------------------------------------------------------
             if (linked)
             {
-                T IscT = (IscA + IscB) * 0.5;
-                T Ax = timeConstantA->process (IscT);
-                T Bx = timeConstantB->process (IscT);
+                const T Isc = (IscA + IscB) * 0.5;
                 capA =
-                capB = (Ax + Bx) * 0.5;
+                capB = (timeConstantA->process (Isc) + timeConstantB->process (Isc)) * 0.5;
             }
             else
             {
                 capA = timeConstantA->process (IscA);
-                capB = timeConstantA->process (IscB);
+                capB = timeConstantB->process (IscB);
             }
         }
         //----------------------------------------------------------------------
-        inline T hardclip (T x, T min, T max) { return (x < min) ? min
-                                                     : (x > max) ? max
-                                                     :             x; }
-        //----------------------------------------------------------------------
         inline void process (float *left, float *right)
         {
-            A = (midside) ? (T)((left[0]  + left[0] ) / SQRT_2) : left[0];
-            B = (midside) ? (T)((right[0] - right[0]) / SQRT_2) : right[0];
-
-            A *= levelA;
-            B *= levelB;
+            input (left[0], right[0], A, B);
 
             if (!feedback) sidechain (A, B);
 
@@ -126,17 +332,154 @@ class StereoProcessor
 
             if ( feedback) sidechain (A, B);
 
-            A = (midside) ? (A + B) / SQRT_2 : A;
-            B = (midside) ? (A - B) / SQRT_2 : B;
+            output (A, B, left[0], right[0]);
+        }
+        //----------------------------------------------------------------------
+        // Block mode: both input transformers run over the whole chunk first,
+        // then the nonlinear tube/sidechain loop runs per sample. Format
+        // conversion is fused with the input level and the output gain/clip.
+        //----------------------------------------------------------------------
+        void processBlock (const SampleBuffer& in, const SampleBuffer& out,
+                           int numSamples)
+        {
+            WAVECHILD670_PROFILE_BLOCK (profiler, numSamples);
+            int offset = 0;
+            while (offset < numSamples)
+            {
+                const int n = jmin (numSamples - offset, blockSize);
+                readInput (in, offset, gateA, gateB, n);
+                if (meter != nullptr) meter->input (gateA, gateB, n);
+                processFront (gateA, gateB, capBufA, capBufB, !feedback, n);
+                processBack (gateA, gateB, capBufA, capBufB, !feedback,
+                             gateA, gateB, n);
+                if (meter != nullptr) meter->output (gateA, gateB, n, gain);
+                writeOutput (gateA, gateB, out, offset, n);
+                offset += n;
+            }
+            publishMeter ();
+        }
+        //----------------------------------------------------------------------
+        void processBlock (float *left, float *right, int numSamples)
+        {
+            const SampleBuffer io = SampleBuffer::planar (left, right, float32Format);
+            processBlock (io, io, numSamples);
+        }
+        //----------------------------------------------------------------------
+        // input matrix and level (in), output matrix, gain and clip (out)
+        //----------------------------------------------------------------------
+        inline void readInput (const SampleBuffer& in, int offset,
+                               T *a, T *b, int n) const
+        {
+            WAVECHILD670_PROFILE_STAGE (profiler, inputStage);
+            Conversion::read<T> (in, offset, a, b, n, levelA, levelB, midside);
+        }
+        //----------------------------------------------------------------------
+        inline void writeOutput (T *a, T *b, const SampleBuffer& out,
+                                 int offset, int n)
+        {
+            WAVECHILD670_PROFILE_STAGE (profiler, outputStage);
+            if (! hardclipout || clipAntialiasing == 0)
+            {
+                Conversion::write<T> (a, b, out, offset, n, gain, midside, hardclipout);
+                if (hardclipout) followClip (a, b, n);
+                return;
+            }
+            //------------------------------------------------------------------
+            // the antialiased clip keeps state: matrix, gain and clip in place
+            //------------------------------------------------------------------
+            int i = 0;
+            for (; i < n; ++i)
+            {
+                T L = (midside) ? (a[i] + b[i]) / SQRT_2 : a[i];
+                T R = (midside) ? (a[i] - b[i]) / SQRT_2 : b[i];
+                a[i] = clipL.process (L * gain);
+                b[i] = clipR.process (R * gain);
+            }
+            Conversion::write<T> (a, b, out, offset, n, 1.0, false, false);
+        }
+        //----------------------------------------------------------------------
+        // the plain clip was fused into the conversion: its history still
+        // takes the last inputs (for a later switch to antialiasing)
+        //----------------------------------------------------------------------
+        inline void followClip (const T *a, const T *b, int n)
+        {
+            int i = jmax (0, n - 2);
+            for (; i < n; ++i)
+            {
+                clipL.process (((midside) ? (a[i] + b[i]) / SQRT_2 : a[i]) * gain);
+                clipR.process (((midside) ? (a[i] - b[i]) / SQRT_2 : b[i]) * gain);
+            }
+        }
+        //----------------------------------------------------------------------
+        // Front stage: input transformers, and the sidechain when it is fed
+        // forward (it then depends on the input only). Takes the levelled
+        // inputs in gA/gB and leaves the tube grid signals there, plus the
+        // level cap voltages in cA/cB.
+        //----------------------------------------------------------------------
+        void processFront (T *gA, T *gB, T *cA, T *cB, bool feedforward, int n)
+        {
+            if (feedforward) sidechainBlock (gA, gB, cA, cB, n);
+            //------------------------------------------------------------------
+            WAVECHILD670_PROFILE_STAGE (profiler, transformerStage);
+            signalAmpA->transformBlock (gA, gA, n);
+            signalAmpB->transformBlock (gB, gB, n);
+        }
+        //----------------------------------------------------------------------
+        // Back stage: push/pull tube pairs and feedback sidechain. Writes the
+        // amplifier outputs to oA/oB (may alias gA/gB).
+        //----------------------------------------------------------------------
+        void processBack (const T *gA, const T *gB, const T *cA, const T *cB,
+                          bool feedforward, T *oA, T *oB, int n)
+        {
+            int i = 0;
+            if (feedforward)
+            {
+                WAVECHILD670_PROFILE_STAGE (profiler, tubeStage);
+                for (; i < n; ++i)
+                {
+                    const T a = signalAmpA->processTubes (gA[i], cA[i]);
+                    const T b = signalAmpB->processTubes (gB[i], cB[i]);
+                    oA[i] = a; oB[i] = b;
+                }
+                return;
+            }
+            //------------------------------------------------------------------
+            // feedback: the sidechain runs on each output sample
+            //------------------------------------------------------------------
+            WAVECHILD670_PROFILE_STAGE (profiler, feedbackStage);
+            for (; i < n; ++i)
+            {
+                const T a = signalAmpA->processTubes (gA[i], capA);
+                const T b = signalAmpB->processTubes (gB[i], capB);
+
+                sidechain (a, b);
+
+                oA[i] = a; oB[i] = b;
+            }
+        }
+        //----------------------------------------------------------------------
+        inline void input (float left, float right, T& a, T& b) const
+        {
+            a = (midside) ? (T)((left + right) / SQRT_2) : left;
+            b = (midside) ? (T)((left - right) / SQRT_2) : right;
+
+            a *= levelA;
+            b *= levelB;
+        }
+        //----------------------------------------------------------------------
+        inline void output (T a, T b, float& left, float& right)
+        {
+            T L = (midside) ? (a + b) / SQRT_2 : a;
+            T R = (midside) ? (a - b) / SQRT_2 : b;
 
-            A *= gain;
-            B *= gain;
+            L *= gain;
+            R *= gain;
 
-            A = (hardclipout) ? hardclip(A, -1.0, 1.0) : A;
-            B = (hardclipout) ? hardclip(B, -1.0, 1.0) : B;
+            L = (hardclipout) ? clipL.process (L) : L;
+            R = (hardclipout) ? clipR.process (R) : R;
 
-            left[0]  = (float)A;
-            right[0] = (float)B;
+            left  = (float)L;
+            right = (float)R;
         }
         //----------------------------------------------------------------------
         void warmup (T timeInSec = 0.5)
@@ -150,22 +493,75 @@ class StereoProcessor
         }
         //----------------------------------------------------------------------
         T Fs; // samplerate
+        int blockSize; // block mode chunk size
         //----------------------------------------------------------------------
         int tcA, tcB;
         bool hardclipout, midside, linked, feedback;
+        int antialiasing, clipAntialiasing;
+        bool diodeBridge;
+        bool shared;    // linked with equal time constants: B follows A
+        Meter* meter;
+        Profiling::Profiler* profiler;
         T A, B, capA, capB, levelA, levelB, thresholdA, thresholdB, gain;
         //----------------------------------------------------------------------
-        ScopedPointer<SignalAmplifier<T>>    signalAmpA;
-        ScopedPointer<SignalAmplifier<T>>    signalAmpB;
+        Arena* arena;   // per-instance storage, else the heap (setArena)
+        //----------------------------------------------------------------------
+        Placed<SignalAmplifier<T>>    signalAmpA;
+        Placed<SignalAmplifier<T>>    signalAmpB;
+        //----------------------------------------------------------------------
+        Placed<LevelTimeConstant<T>>  timeConstantA;
+        Placed<LevelTimeConstant<T>>  timeConstantB;
         //----------------------------------------------------------------------
-        ScopedPointer<LevelTimeConstant<T>>  timeConstantA;
-        ScopedPointer<LevelTimeConstant<T>>  timeConstantB;
+        Placed<SidechainAmplifier<T>> sidechainAmpA;
+        Placed<SidechainAmplifier<T>> sidechainAmpB;
+        //----------------------------------------------------------------------
+        enum { numScratch = 6 };
+        HeapBlock<T> scratch;   // the scratch below, without an arena
+        T *gateA, *gateB, *capBufA, *capBufB; // block mode scratch
+        T *potA, *potB;                       // threshold pots
+        //----------------------------------------------------------------------
+        static size_t scratchSize (int size) { return numScratch * size * sizeof (T); }
+        //----------------------------------------------------------------------
+        void release ()
+        {
+            signalAmpA.reset ();    signalAmpB.reset ();
+            sidechainAmpA.reset (); sidechainAmpB.reset ();
+            timeConstantA.reset (); timeConstantB.reset ();
+        }
         //----------------------------------------------------------------------
-        ScopedPointer<SidechainAmplifier<T>> sidechainAmpA;
-        ScopedPointer<SidechainAmplifier<T>> sidechainAmpB;
+        WDF::ADAA<T, WDF::HardClip<T>> clipL, clipR; // output clip
         //----------------------------------------------------------------------
 };
 //==============================================================================
+// Plugin parameter mapping (index and normalized value, see
+// Wavechild670Processor::setParameter), also used by the capture replay
+//==============================================================================
+enum { numParameters = 11 };
+//------------------------------------------------------------------------------
+template <typename T>
+static void applyParameter (StereoProcessor<T>& p, int index, float value)
+{
+    switch (index)
+    {
+        case  0: p.levelA = value; break;
+        case  1: p.thresholdA = value; break;
+        case  2: p.parameters (int(value * 10.f), p.tcB); break;
+        //----------------------------------------------------------------------
+        case  3: p.levelB = value; break;
+        case  4: p.thresholdB = value; break;
+        case  5: p.parameters (p.tcA, int(value * 10.f)); break;
+        //----------------------------------------------------------------------
+        case  6: p.feedback = (value > 0.5f) ? true : false; break;
+        case  7: p.midside = (value > 0.5f) ? true : false; break;
+        case  8: p.linked = (value > 0.5f) ? true : false; break;
+        //----------------------------------------------------------------------
+        case  9: p.gain = value; break;
+        case 10: p.hardclipout = (value > 0.5f) ? true : false; break;
+        //----------------------------------------------------------------------
+        default: break;
+    };
+}
+//==============================================================================
 #undef SQRT_2
 //==============================================================================
 } // namespace Wavechild670
@@ -0,0 +1,343 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+#ifndef __F670L_SWEEP_HPP_C46642C8__
+#define __F670L_SWEEP_HPP_C46642C8__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//------------------------------------------------------------------------------
+#include "f670l_ProcessingEngine.hpp"
+#include "f670l_Analysis.hpp"
+//==============================================================================
+namespace Wavechild670 {
+namespace Sweep {
+//==============================================================================
+// Parallel parameter sweep
+//------------------------------------------------------------------------------
+// Every point of a grid (rate x level x time constant x feedback x link)
+// runs one compact synthetic stimulus through its own StereoProcessor. The
+// instances of a batch are the slots of a ProcessingEngine and advance in
+// lock-step chunks on its work-stealing pool; each instance is initialized
+// cold and the stimulus starts with the silence the warmup would have fed.
+//
+// Stimulus (1 kHz tone, left at full scale, right 12 dB lower so linking
+// shows up on the right channel):
+//
+//      silence 0.5 s | step: -30 dB 1 s, 0 dB 1 s, -30 dB release tail |
+//      static curve: -36 .. 0 dB in 6 dB steps, 0.2 s settle + 0.1 s window
+//
+// The release tail follows the time constant switch (25 s for position 6).
+//==============================================================================
+enum { numStaticLevels = 7 };
+//------------------------------------------------------------------------------
+static inline double staticLevelDb (int k) { return -36.0 + 6.0 * k; }
+//------------------------------------------------------------------------------
+static const double releaseTail[6] = { 1.0, 2.0, 4.0, 8.0, 12.0, 25.0 }; // s
+static const double stepLow = 0.03, stepHigh = 1.0, rightScale = 0.25;
+static const double toneFreq = 1000.0;
+//==============================================================================
+struct Stimulus
+{
+    Stimulus (double Fs, int tc)
+    {
+        warm   = (int) (0.5 * Fs);
+        n1     = (int) (1.0 * Fs);
+        n2     = (int) (1.0 * Fs);
+        n3     = (int) (releaseTail[jlimit (0, 5, tc)] * Fs);
+        settle = (int) (0.2 * Fs);
+        window = (int) (0.1 * Fs);
+        start  = warm + n1 + n2 + n3;
+        length = start + numStaticLevels * (settle + window);
+        //----------------------------------------------------------------------
+        x.calloc (length);
+        Analysis::tone (x, length, toneFreq, Fs, 1.0);
+        int i = 0;
+        for (; i < warm; ++i)           x[i] = 0.0f;
+        for (; i < warm + n1; ++i)      x[i] *= (float) stepLow;
+        for (; i < warm + n1 + n2; ++i) x[i] *= (float) stepHigh;
+        for (; i < start; ++i)          x[i] *= (float) stepLow;
+        for (int k = 0; k < numStaticLevels; ++k)
+        {
+            const float a = (float) Analysis::fromDb (staticLevelDb (k));
+            for (int j = 0; j < settle + window; ++j, ++i) x[i] *= a;
+        }
+    }
+    //--------------------------------------------------------------------------
+    int staticWindow (int k) const { return start + k * (settle + window) + settle; }
+    //--------------------------------------------------------------------------
+    int warm, n1, n2, n3, settle, window, start, length;
+    HeapBlock<float> x;
+};
+//==============================================================================
+// Grid of parameters, one row of results per point
+//==============================================================================
+struct Point
+{
+    double rate, level;
+    int tc;
+    bool feedback, linked;
+};
+//------------------------------------------------------------------------------
+struct Grid
+{
+    Grid ()
+    {
+        rates.add (44100.0); rates.add (48000.0); rates.add (96000.0);
+        levels.add (0.25); levels.add (0.5); levels.add (0.75); levels.add (1.0);
+        for (int tc = 0; tc < 6; ++tc) timeConstants.add (tc);
+    }
+    //--------------------------------------------------------------------------
+    int pointsPerRate () const { return levels.size() * timeConstants.size() * 4; }
+    int numPoints () const { return rates.size() * pointsPerRate(); }
+    //--------------------------------------------------------------------------
+    // level is the fastest index, the time constant the slowest (a batch
+    // then mostly shares one stimulus length)
+    //--------------------------------------------------------------------------
+    Point point (int rateIndex, int k) const
+    {
+        Point p;
+        p.rate  = rates[rateIndex];
+        p.level = levels[k % levels.size()];   k /= levels.size();
+        p.feedback = (k & 1) != 0;
+        p.linked   = (k & 2) != 0;             k /= 4;
+        p.tc    = timeConstants[k];
+        return p;
+    }
+    //--------------------------------------------------------------------------
+    Array<double> rates, levels;
+    Array<int> timeConstants;
+};
+//==============================================================================
+// Columnar results: column c of row r at data[c * numRows + r]
+//==============================================================================
+enum Column
+{
+    rateColumn, levelColumn, tcColumn, feedbackColumn, linkedColumn,
+    attackColumn, releaseColumn, lowGainColumn, highGainColumn, linkGainColumn,
+    gainColumn,                                 // numStaticLevels columns
+    thdColumn = gainColumn + numStaticLevels,   // numStaticLevels columns
+    numColumns = thdColumn + numStaticLevels
+};
+//------------------------------------------------------------------------------
+static String columnName (int c)
+{
+    static const char* const names[] =
+    {
+        "rate", "level", "tc", "feedback", "linked",
+        "attack_ms", "release_ms", "step_low_db", "step_high_db", "link_gain_db"
+    };
+    if (c < gainColumn) return names[c];
+    const bool thd = c >= thdColumn;
+    const int k = c - (thd ? thdColumn : gainColumn);
+    return String (thd ? "thd_pct_" : "gain_db_") + String (roundToInt (staticLevelDb (k)));
+}
+//------------------------------------------------------------------------------
+struct Table
+{
+    enum { magic = 0x57363753 }; // "W67S"
+    //--------------------------------------------------------------------------
+    Table (int rows) : numRows (rows) { data.calloc (numColumns * numRows); }
+    //--------------------------------------------------------------------------
+    float* column (int c) const { return data + c * numRows; }
+    //--------------------------------------------------------------------------
+    // magic, rows, columns, the column names, then each column (float32)
+    //--------------------------------------------------------------------------
+    bool write (const File& f) const
+    {
+        f.deleteFile ();
+        FileOutputStream out (f);
+        if (! out.openedOk ()) return false;
+        out.writeInt (magic); out.writeInt (numRows); out.writeInt (numColumns);
+        for (int c = 0; c < numColumns; ++c) out.writeString (columnName (c));
+        return out.write (data, numColumns * numRows * sizeof (float));
+    }
+    //--------------------------------------------------------------------------
+    const int numRows;
+    HeapBlock<float> data;
+};
+//==============================================================================
+// Measurements of one rendered stimulus into one row
+//==============================================================================
+static void measure (const Stimulus& s, const float* left, const float* right,
+                     double Fs, const Point& p, Table& table, int row)
+{
+    float v[numColumns];
+    v[rateColumn] = (float) p.rate;         v[levelColumn] = (float) p.level;
+    v[tcColumn] = (float) p.tc;
+    v[feedbackColumn] = p.feedback ? 1.0f : 0.0f;
+    v[linkedColumn] = p.linked ? 1.0f : 0.0f;
+    //--------------------------------------------------------------------------
+    const int step = s.warm;
+    const Analysis::StepResponse r = Analysis::stepAnalysis (s.x + step, left + step,
+                                                             s.n1, s.n2, s.n3, Fs, toneFreq);
+    v[attackColumn]   = (float) (r.attack * 1e3);
+    v[releaseColumn]  = (float) (r.release * 1e3);
+    v[lowGainColumn]  = (float) r.lowGain;
+    v[highGainColumn] = (float) r.highGain;
+    //--------------------------------------------------------------------------
+    for (int k = 0; k < numStaticLevels; ++k)
+    {
+        const int w = s.staticWindow (k);
+        const double a = Analysis::fromDb (staticLevelDb (k));
+        v[gainColumn + k] = (float) Analysis::toDb (Analysis::amplitude (left + w, s.window, toneFreq, Fs) / a);
+        v[thdColumn + k]  = (float) (100.0 * Analysis::harmonicDistortion (left + w, s.window, toneFreq, Fs));
+    }
+    const int top = s.staticWindow (numStaticLevels - 1);
+    v[linkGainColumn] = (float) Analysis::toDb (Analysis::amplitude (right + top, s.window, toneFreq, Fs)
+                                                / (rightScale * Analysis::fromDb (staticLevelDb (numStaticLevels - 1))));
+    //--------------------------------------------------------------------------
+    for (int c = 0; c < numColumns; ++c) table.column (c)[row] = v[c];
+}
+//==============================================================================
+// Batch runner: numInstances points per batch on the engine pool
+//==============================================================================
+class Runner
+{
+    public:
+        Runner (const Grid& g, int numInstances, int numThreads = 0,
+                int chunkSize = 4096, int blockSize = 512)
+            : grid (g), engine (numInstances, numThreads),
+              chunk (jmax (1, chunkSize)), block (jmax (1, blockSize))
+        {
+            buffers.calloc (engine.getNumInstances ());
+            for (int i = 0; i < engine.getNumInstances (); ++i) lanes.add (new Lane());
+        }
+        //----------------------------------------------------------------------
+        // every point of one rate, rows rateIndex * pointsPerRate onwards
+        //----------------------------------------------------------------------
+        void run (int rateIndex, Table& table)
+        {
+            const double Fs = grid.rates[rateIndex];
+            OwnedArray<Stimulus> stimuli;
+            for (int tc = 0; tc < 6; ++tc) stimuli.add (nullptr);
+            for (int t = 0; t < grid.timeConstants.size(); ++t)
+            {
+                const int tc = jlimit (0, 5, grid.timeConstants[t]);
+                if (stimuli[tc] == nullptr) stimuli.set (tc, new Stimulus (Fs, tc));
+            }
+            //------------------------------------------------------------------
+            const int numPoints = grid.pointsPerRate ();
+            const int numInstances = engine.getNumInstances ();
+            for (int first = 0; first < numPoints; first += numInstances)
+            {
+                const int m = jmin (numInstances, numPoints - first);
+                int longest = 0;
+                for (int i = 0; i < numInstances; ++i)
+                {
+                    Lane& lane = *lanes[i];
+                    lane.stimulus = nullptr;
+                    if (i >= m) continue;
+                    lane.point = grid.point (rateIndex, first + i);
+                    lane.stimulus = stimuli[jlimit (0, 5, lane.point.tc)];
+                    lane.prepare (chunk, lane.stimulus->length);
+                    longest = jmax (longest, lane.stimulus->length);
+                    //----------------------------------------------------------
+                    StereoProcessor<T>& p = engine.getInstance (i);
+                    p.levelA = p.levelB = lane.point.level;
+                    p.tcA = p.tcB = lane.point.tc;
+                    p.feedback = lane.point.feedback;
+                    p.linked = lane.point.linked;
+                }
+                engine.init (Fs, block, false);
+                //--------------------------------------------------------------
+                for (int offset = 0; offset < longest; offset += chunk)
+                {
+                    for (int i = 0; i < numInstances; ++i)
+                        buffers[i] = lanes[i]->feed (offset, chunk);
+                    engine.process (buffers);
+                    for (int i = 0; i < numInstances; ++i)
+                        lanes[i]->collect (offset, buffers[i].numSamples);
+                }
+                //--------------------------------------------------------------
+                for (int i = 0; i < m; ++i)
+                    measure (*lanes[i]->stimulus, lanes[i]->outL, lanes[i]->outR,
+                             Fs, lanes[i]->point, table,
+                             rateIndex * numPoints + first + i);
+            }
+        }
+        //----------------------------------------------------------------------
+        int getNumWorkers () const { return engine.getNumWorkers (); }
+        //----------------------------------------------------------------------
+    private:
+        typedef double T;
+        typedef ProcessingEngine<T>::Buffer Buffer;
+        //----------------------------------------------------------------------
+        // one instance: chunk buffers in, whole stimulus out
+        //----------------------------------------------------------------------
+        struct Lane
+        {
+            Lane () : stimulus (nullptr), chunk (0), capacity (0) {}
+            //------------------------------------------------------------------
+            void prepare (int chunkSize, int length)
+            {
+                if (chunk < chunkSize) { chunk = chunkSize; l.malloc (chunk); r.malloc (chunk); }
+                if (capacity < length) { capacity = length; outL.malloc (capacity); outR.malloc (capacity); }
+            }
+            //------------------------------------------------------------------
+            Buffer feed (int offset, int size)
+            {
+                Buffer b = { l, r, 0 };
+                if (stimulus == nullptr) return b;
+                b.numSamples = jlimit (0, size, stimulus->length - offset);
+                for (int i = 0; i < b.numSamples; ++i)
+                {
+                    l[i] = stimulus->x[offset + i];
+                    r[i] = (float) (rightScale * l[i]);
+                }
+                return b;
+            }
+            //------------------------------------------------------------------
+            void collect (int offset, int n)
+            {
+                if (n <= 0) return;
+                memcpy (outL + offset, l, n * sizeof (float));
+                memcpy (outR + offset, r, n * sizeof (float));
+            }
+            //------------------------------------------------------------------
+            Point point;
+            const Stimulus* stimulus;
+            int chunk, capacity;
+            HeapBlock<float> l, r, outL, outR;
+        };
+        //----------------------------------------------------------------------
+        const Grid& grid;
+        ProcessingEngine<T> engine;
+        const int chunk, block;
+        HeapBlock<Buffer> buffers;
+        OwnedArray<Lane> lanes;
+        //----------------------------------------------------------------------
+        JUCE_DECLARE_NON_COPYABLE (Runner)
+};
+//==============================================================================
+} // namespace Sweep
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_SWEEP_HPP_C46642C8__
+//==============================================================================
\ No newline at end of file
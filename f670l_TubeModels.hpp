@@ -0,0 +1,151 @@
+//==============================================================================
+/**
+    Wavechild 670
+    -------------
+    Wave digital filter based emulation of a famous 1950's tube stereo limiter
+
+    WDF++ based source code by Maxime Coorevits (Nord, France) in 2013
+
+    Some part are inspired by the Peter Raffensperger project: Wavechild670,
+    a command line with python WDF generator that produce C++ code of the circuit.
+
+    Major restructuration:
+    ----------------------
+        * WDF++ based project (single WDF++.hpp file)
+        * full C++, zero-dependencies except JUCE (core API, AudioProcessor).
+        * JUCE Plugin wrapper processor (VST, AU ...)
+        * Photo-Realistic GUI
+
+    Reference:
+    ----------
+    Toward a Wave Digital Filter Model of the Fairchild 670 Limiter,
+    Raffensperger, P. A., (2012).
+    Proc. of the 15th International Conference on Digital Audio Effects (DAFx-12),
+    York, UK, September 17-21, 2012.
+    Note:
+    -----
+    Fairchild (R) a registered trademark of Avid Technology, Inc.,
+    which is in no way associated or affiliated with the author.
+
+**/
+//==============================================================================
+#ifndef __F670L_TUBE_MODELS_HPP_6A2C91E4__
+#define __F670L_TUBE_MODELS_HPP_6A2C91E4__
+//==============================================================================
+#include "../JuceLibraryCode/JuceHeader.h"
+//==============================================================================
+namespace Wavechild670 {
+//==============================================================================
+// Triode models (compile-time policies)
+//------------------------------------------------------------------------------
+// A model provides, as static inline members:
+//
+//      static const char* name ();
+//      static T current (T Vgk, T Vak, T& dVgk, T& dVak);
+//
+// current() returns the plate current (amps) of one triode and its partial
+// derivatives, with the model's valid-range clamps applied (a clamped
+// variable gets a zero derivative). Stages take the model as a template
+// parameter, so the Newton solvers inline it.
+//==============================================================================
+// GE 6386 Remote Cutoff Triode
+//------------------------------------------------------------------------------
+// The model parameters were calculated using Levenberg-Marquardt least
+// squares estimation and hand tuning to fit the 6386 characteristics
+// as given in the General Electric 6386 datasheet.
+// by Peter Raffensperger (2012)
+//
+// Range: Vak > 0 (else cut off), Vgk <= 0 (grid current not modeled).
+//==============================================================================
+template <typename T>
+struct Triode6386
+{
+    static const char* name () { return "6386"; }
+    //--------------------------------------------------------------------------
+    static inline T current (T Vgk, T Vak, T& dVgk, T& dVak)
+    {
+        dVgk = dVak = 0.0;
+        if (Vak <= 0.0) return 0.0;
+        const bool cut = (Vgk > 0.0);
+        if (cut) Vgk = 0.0;
+        //----------------------------------------------------------------------
+        const T e = exp ((-0.03922*Vak) - (0.2*Vgk));
+        const T I = (3.981e-8 * pow(Vak, 2.383))
+                  / (pow((0.5 - 0.1*Vgk), 1.8)
+                  * (0.5 + e));
+        //----------------------------------------------------------------------
+        // d(log Ia) from each factor
+        //----------------------------------------------------------------------
+        const T s = e / (0.5 + e);
+        dVak = I * (2.383/Vak + 0.03922*s);
+        dVgk = cut ? 0.0 : I * (0.18/(0.5 - 0.1*Vgk) + 0.2*s);
+        return I;
+    }
+};
+//==============================================================================
+// Koren triode
+//------------------------------------------------------------------------------
+//      E1 = Vak/kp . log (1 + exp (kp (1/mu + Vgk / sqrt (kvb + Vak^2))))
+//      Ia = E1^ex / kg1                                        (E1 > 0)
+//
+// Norman Koren, "Improved VT models for SPICE simulations" (1996).
+// P provides mu, ex, kg1, kp, kvb as static functions.
+//
+// Range: Vak > 0 (else cut off), Vgk <= 0 (grid current not modeled).
+//==============================================================================
+template <typename T, class P>
+struct KorenTriode
+{
+    static inline T current (T Vgk, T Vak, T& dVgk, T& dVak)
+    {
+        dVgk = dVak = 0.0;
+        if (Vak <= 0.0) return 0.0;
+        const bool cut = (Vgk > 0.0);
+        if (cut) Vgk = 0.0;
+        //----------------------------------------------------------------------
+        const T kp = P::kp(), ex = P::ex();
+        const T r = sqrt (P::kvb() + Vak*Vak);
+        const T u = kp * (1.0/P::mu() + Vgk/r);
+        const T L = (u > 30.0) ? u : log1p (exp (u));   // softplus
+        const T E1 = Vak/kp * L;
+        if (E1 <= 0.0) return 0.0;
+        //----------------------------------------------------------------------
+        const T I = pow (E1, ex) / P::kg1();
+        const T sigma = 1.0 / (1.0 + exp (-u));
+        const T dI = ex * I / E1;                       // dIa/dE1
+        dVak = dI * (L/kp - sigma * Vgk * Vak*Vak / (r*r*r));
+        dVgk = cut ? 0.0 : dI * Vak * sigma / r;
+        return I;
+    }
+};
+//==============================================================================
+// 12AX7 (sidechain threshold stage), Koren's published parameters
+//==============================================================================
+template <typename T>
+struct Triode12AX7 : KorenTriode<T, Triode12AX7<T> >
+{
+    static const char* name () { return "12AX7"; }
+    static inline T mu ()  { return 100.0; }
+    static inline T ex ()  { return 1.4; }
+    static inline T kg1 () { return 1060.0; }
+    static inline T kp ()  { return 600.0; }
+    static inline T kvb () { return 300.0; }
+};
+//==============================================================================
+// 12BH7 (sidechain drive stage), Koren-style fit
+//==============================================================================
+template <typename T>
+struct Triode12BH7 : KorenTriode<T, Triode12BH7<T> >
+{
+    static const char* name () { return "12BH7"; }
+    static inline T mu ()  { return 16.37; }
+    static inline T ex ()  { return 1.156; }
+    static inline T kg1 () { return 1460.0; }
+    static inline T kp ()  { return 315.2; }
+    static inline T kvb () { return 300.0; }
+};
+//==============================================================================
+} // namespace Wavechild670
+//==============================================================================
+#endif  // __F670L_TUBE_MODELS_HPP_6A2C91E4__
+//==============================================================================
\ No newline at end of file
@@ -36,11 +36,12 @@
 #include "WDF++.hpp"
 //------------------------------------------------------------------------------
 #include "f670l_NonIdealTransformer.hpp"
+#include "f670l_TubeModels.hpp"
 //==============================================================================
 namespace Wavechild670 {
 //==============================================================================
-template <typename T>
-class TubeStage : public WDF::OnePort<T>, WDF::NewtonRaphson<T>
+template <typename T, class Tube = Triode6386<T> >
+class TubeStage
 {
     public:
         TubeStage (T Fs)
@@ -50,108 +51,86 @@ class TubeStage : public WDF::OnePort<T>, WDF::NewtonRaphson<T>
               Rout (600.0,      "Rout"),      // signal output
               Rsc (1000.0,      "Rsc"),       // sidechain input
               //----------------------------------------------------------------
-              Ck (2.0*4e-6, Fs, "2C1"),       // cathode capacitor (twice)
-              Vk (-3.1,  705.0, "Vbal R11"),  // cathode (balance)
               Vp (240.0,  33.0, "240V R12"),  // plate (power supply)
               //----------------------------------------------------------------
-              Vgk (0.0), Iak (0.0), lVk (0.0) // lVk = last Vk (cathode voltage)
+              transfo (Fs, 1.0/9.0,           // output transformer (Tx20)
+                       100e-6, 5.0, 35.7, 10e3, 400e-6, 50.0, 1e-12, "Tx20")
               //----------------------------------------------------------------
         {
+            wiring ();
         }
         //----------------------------------------------------------------------
-        virtual String label () const { return "Tube"; }
+        String label () const { return "Tube"; }
         //----------------------------------------------------------------------
-        virtual inline T reflected ()
-        {
-            a = root.reflected (); return a;
-        }
+        // plate network (output transformer + supply), seen from the plate
+        // node: the cathode junction owns it as a child
+        //----------------------------------------------------------------------
+        inline WDF::OnePort<T>* plate () { return &serie_T; }
+        //----------------------------------------------------------------------
+        // anode current of the paralleled triodes and its partial derivatives
+        // (the nonlinearity is solved by the cathode junction owner)
         //----------------------------------------------------------------------
-        virtual inline void incident (T wave)
+        inline T current (T Vgk, T Vak, T& dVgk, T& dVak) const
         {
-            b = nonlinear (wave);
-            root.incident (b);
-            lVk = Vk.voltage (); // z-1
+            T I = Tube::current (Vgk, Vak, dVgk, dVak);
+            dVgk *= NTI; dVak *= NTI;
+            return I * NTI;
         }
         //----------------------------------------------------------------------
-        inline T process (T Vgate)
+        // Small-signal model at an operating point: I + gm.dVgk + ga.dVak,
+        // with the second derivatives estimating the error of the linear
+        // update (second order Taylor term: an estimate, not a bound, as the
+        // higher order terms are left out)
+        //----------------------------------------------------------------------
+        struct SmallSignal
+        {
+            T Vgk, Vak, I, gm, ga, hgg, hga, haa;
+            //------------------------------------------------------------------
+            inline T errorEstimate (T vgk, T vak) const
+            {
+                const T g = vgk - Vgk, a = vak - Vak;
+                return 0.5 * fabs (hgg*g*g + 2.0*hga*g*a + haa*a*a);
+            }
+        };
+        //----------------------------------------------------------------------
+        void linearize (T Vgk, T Vak, SmallSignal& s) const
         {
-            reflected ();
-            incident (Vgate);
-            return transformer.Vout();
+            const T h = 1e-3; // V, second derivatives by differences
+            T gg, ga, aa;
+            s.Vgk = Vgk; s.Vak = Vak;
+            s.I = current (Vgk, Vak, s.gm, s.ga);
+            current (Vgk + h, Vak, gg, ga);
+            s.hgg = (gg - s.gm) / h;
+            s.hga = (ga - s.ga) / h;
+            current (Vgk, Vak + h, gg, aa);     // only d/dVak is used there
+            s.haa = (aa - s.ga) / h;
         }
         //----------------------------------------------------------------------
-        // Fairchild 670 Class-A Signal Amplifier (with Push/Pull topology)
+        inline T Vout () { return transfo.Vout(); }
+        //----------------------------------------------------------------------
+        template <class Archive> void state (Archive& s) { transfo.state (s); }
         //----------------------------------------------------------------------
-        inline void wiring (WDF::OnePort<T>* coupled)
+        // Fairchild 670 Class-A Signal Amplifier (one side of the Push/Pull)
+        //----------------------------------------------------------------------
+        inline void wiring ()
         {
             paral_O.connect (&Rout,    &Rsc);
-            transfo.connect (&serie_T, &paral_O);
+            transfo.connectChild (&paral_O);
             serie_T.connect (&transfo, &Vp);
-            //------------------------------------------------------------------
-            serie_K.connect (&Ck,       coupled);
-            paral_K.connect (&Vk,      &serie_K);
-            //------------------------------------------------------------------
-               root.connect (&serie_T, &paral_K);
         }
         //----------------------------------------------------------------------
     protected:
         //----------------------------------------------------------------------
-        WDF::VoltageSource<T>   Vk;
+        enum { NTI = 2 };                   // triodes in parallel
+        //----------------------------------------------------------------------
         WDF::VoltageSource<T>   Vp;
-        WDF::Capacitor<T>       Ck;
         WDF::Resistor<T>        Rout;
         WDF::Resistor<T>        Rsc;
         //----------------------------------------------------------------------
         NonIdealTransformer<T>  transfo;
         //----------------------------------------------------------------------
-        WDF::Serie<T>           root;
-        WDF::Serie<T>           serie_K;
         WDF::Serie<T>           serie_T;
         WDF::Parallel<T>        paral_O;
-        WDF::Parallel<T>        paral_K;
-        //----------------------------------------------------------------------
-    private:
-        //----------------------------------------------------------------------
-        // nonlinearity is isolated at trunk (wdf requirement)
-        //----------------------------------------------------------------------
-        inline T nonlinear (T Vgate)
-        {
-            Vgk = Vgate - lVk;              // grid-cathode voltage
-            //------------------------------------------------------------------
-            Iak = 0.0;                      // computed by solve()
-            T Vak = solve ();               // Newton/Raphson iterations
-            //------------------------------------------------------------------
-            return Vak - root.R()*Iak;      // estimate reflected
-        }
-        //----------------------------------------------------------------------
-        // implicit equation will be evaluate by Newton/Raphson solver
-        //----------------------------------------------------------------------
-        virtual inline T evaluate (T Vak)
-        {
-            Iak = Ia (Vgk, Vak) * NTI;
-            return Vak + R*Iak - a;         // [ Vak + R*Iak - a = 0 ]
-        }
-        //----------------------------------------------------------------------
-        // GE 6386 Remote Cutoff Triode
-        //----------------------------------------------------------------------
-        // The model parameters were calculated using Levenberg-Marquardt least
-        // squares estimation and hand tuning to fit the 6386 characteristics
-        // as given in the General Electric 6386 datasheet.
-        // by Peter Raffensperger (2012)
-        //----------------------------------------------------------------------
-        inline T Ia (T Vgk, T Vak)          // Ia = anode current (in amps)
-        {
-            if (Vak < 0.0) Vak = 0.0;
-            if (Vgk > 0.0) Vgk = 0.0;
-            //------------------------------------------------------------------
-            return (3.981e-8 * pow(Vak, 2.383))
-                 / (pow((0.5 - 0.1*Vgk), 1.8)
-                 * (0.5 + exp((-0.03922*Vak)
-                 - (0.2*Vgk))));
-        }
-        //----------------------------------------------------------------------
-    private:
-        T Vgk, Iak, lVk;
         //----------------------------------------------------------------------
 };
 //==============================================================================